@@ -0,0 +1,193 @@
+/**
+ * @file main.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief xf_heap 基准测试
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "xf_heap.h"
+#ifdef __linux__
+#include <time.h>
+#include "xf_heap_linux.h"
+#endif
+
+/* ==================== [Defines] =========================================== */
+
+#define BENCH_HEAP_SIZE         (64 * 1024)
+#define BENCH_SHORT_SLOTS       64
+#define BENCH_LONG_SLOTS        96
+#define BENCH_STEPS             20000
+#define BENCH_LONG_PERIOD       200
+
+#define BENCH_TLB_REGION_SIZE   (256u << 20)
+#define BENCH_TLB_BUFFER_SIZE   (240u << 20)
+#define BENCH_TLB_ACCESSES      (20u * 1000 * 1000)
+
+/* ==================== [Static Variables] ================================== */
+
+static uint8_t s_heap_arr[BENCH_HEAP_SIZE];
+static void *s_short[BENCH_SHORT_SLOTS];
+static void *s_long[BENCH_LONG_SLOTS];
+static uint32_t s_seed;
+
+/* ==================== [Static Functions] ================================== */
+
+static uint32_t bench_rand(void)
+{
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed;
+}
+
+static void bench_heap_init(void)
+{
+    xf_heap_region_t heap_regions[] = {
+        {s_heap_arr, BENCH_HEAP_SIZE},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+}
+
+/* 二分查找当前能申请到的最大内存 */
+static unsigned int bench_largest_block(void)
+{
+    unsigned int low = 0, high = xf_heap_get_free_size();
+    unsigned int mid;
+    void *p;
+
+    while (low < high) {
+        mid = low + (high - low + 1) / 2;
+        p = xf_malloc(mid);
+        if (p != NULL) {
+            xf_free(p);
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief 短生命周期缓冲区反复申请释放，期间穿插申请长生命周期的配置对象，
+ *        最后释放所有短生命周期内存，统计剩余内存的碎片程度
+ */
+static void bench_fragmentation(const char *name, int use_hint)
+{
+    unsigned int failed = 0, long_num = 0;
+    unsigned int free_size, largest;
+    int i, slot;
+
+    s_seed = 0x12345678;
+    bench_heap_init();
+
+    for (i = 0; i < BENCH_SHORT_SLOTS; i++) {
+        s_short[i] = NULL;
+    }
+
+    for (i = 0; i < BENCH_STEPS; i++) {
+        slot = bench_rand() % BENCH_SHORT_SLOTS;
+        xf_free(s_short[slot]);
+        s_short[slot] = xf_malloc(16 + bench_rand() % 512);
+        if (s_short[slot] == NULL) {
+            failed++;
+        }
+
+        if ((i % BENCH_LONG_PERIOD == 0) && (long_num < BENCH_LONG_SLOTS)) {
+            unsigned int size = 32 + bench_rand() % 96;
+            if (use_hint) {
+                s_long[long_num] = xf_malloc_hint(size, XF_HEAP_LIFETIME_LONG);
+            } else {
+                s_long[long_num] = xf_malloc(size);
+            }
+            if (s_long[long_num] == NULL) {
+                failed++;
+            } else {
+                long_num++;
+            }
+        }
+    }
+
+    for (i = 0; i < BENCH_SHORT_SLOTS; i++) {
+        xf_free(s_short[i]);
+    }
+
+    free_size = xf_heap_get_free_size();
+    largest = bench_largest_block();
+    printf("%-16s long=%-3u failed=%-5u free=%-6u largest=%-6u fragmentation=%5.1f%%\n",
+           name, long_num, failed, free_size, largest,
+           100.0 * (1.0 - (double)largest / (double)free_size));
+
+    for (i = 0; i < (int)long_num; i++) {
+        xf_free(s_long[i]);
+    }
+    xf_heap_uninit();
+}
+
+#ifdef __linux__
+/**
+ * @brief 在不同页类型的内存区域上随机访问一块大内存，对比 TLB 未命中的开销
+ */
+static void bench_tlb(const char *name, xf_heap_page_t page)
+{
+    static const char *page_names[] = {"normal", "transparent", "hugetlb"};
+    xf_heap_region_t heap_regions[2] = {0};
+    struct timespec start, end;
+    uint64_t *buffer, sum = 0;
+    unsigned int count = BENCH_TLB_BUFFER_SIZE / sizeof(uint64_t);
+    unsigned int i;
+    double ns;
+
+    if (xf_heap_linux_map(&heap_regions[0], BENCH_TLB_REGION_SIZE, -1, &page) != 0) {
+        printf("%-16s map failed\n", name);
+        return;
+    }
+    xf_heap_init(heap_regions);
+
+    buffer = xf_malloc(BENCH_TLB_BUFFER_SIZE);
+    if (buffer != NULL) {
+        /* 先写一遍触发缺页，计时只包含访问开销 */
+        for (i = 0; i < count; i++) {
+            buffer[i] = i;
+        }
+
+        s_seed = 0x12345678;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < BENCH_TLB_ACCESSES; i++) {
+            sum += buffer[bench_rand() % count];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        ns = (double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec);
+        printf("%-16s page=%-12s %6.2f ns/access (sum=%llu)\n",
+               name, page_names[page], ns / BENCH_TLB_ACCESSES, (unsigned long long) sum);
+        xf_free(buffer);
+    }
+
+    xf_heap_uninit();
+    xf_heap_linux_unmap(&heap_regions[0]);
+}
+#endif
+
+/* ==================== [Global Functions] ================================== */
+
+int main(void)
+{
+    printf("== fragmentation: short-lived churn with long-lived objects ==\n");
+    bench_fragmentation("xf_malloc", 0);
+    bench_fragmentation("xf_malloc_hint", 1);
+#ifdef __linux__
+    printf("== tlb: random access over %u MiB ==\n", BENCH_TLB_BUFFER_SIZE >> 20);
+    bench_tlb("4k pages", XF_HEAP_PAGE_NORMAL);
+    bench_tlb("huge pages", XF_HEAP_PAGE_TRANSPARENT);
+    bench_tlb("hugetlb", XF_HEAP_PAGE_HUGETLB);
+#endif
+    return 0;
+}
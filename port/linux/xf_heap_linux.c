@@ -0,0 +1,458 @@
+/**
+ * @file xf_heap_linux.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief Linux 下的内存区域提供者，支持大页和 NUMA 节点绑定
+ *      @note 不依赖 libnuma，mbind 直接通过系统调用完成，CPU 到节点的映射从 sysfs 读取
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+/* ==================== [Includes] ========================================== */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "xf_heap_linux.h"
+
+/* ==================== [Defines] =========================================== */
+
+/* 大页大小 */
+#ifndef XF_HEAP_LINUX_HUGE_PAGE_SIZE
+#define XF_HEAP_LINUX_HUGE_PAGE_SIZE (2u << 20)
+#endif
+
+/* 单个内存区域的大小上限，内存块大小的高两位被用作标志 */
+#define LINUX_MAX_SIZE ((1u << 30) - XF_HEAP_LINUX_HUGE_PAGE_SIZE)
+
+/* mbind 的内存策略，见 linux/mempolicy.h */
+#define LINUX_MPOL_BIND 2
+
+/* 节点掩码的位数 */
+#define LINUX_MASK_BITS (sizeof(unsigned long) * 8)
+
+/* ==================== [Static Prototypes] ================================= */
+
+static size_t linux_align(size_t size, size_t align);
+static void *linux_map_hugetlb(size_t length);
+static void *linux_map_transparent(size_t length);
+static void *linux_map_normal(size_t length);
+static int linux_transparent_enabled(void);
+static int linux_bind(void *addr, size_t length, int node);
+static int linux_read_list(const char *path, unsigned char *set, int max);
+static void linux_map_cpus(void);
+
+/* ==================== [Static Variables] ================================== */
+
+/* 节点对应的分片编号，由 xf_heap_linux_map_nodes 填写 */
+static unsigned int s_node_shard[XF_HEAP_LINUX_MAX_NODES];
+static int s_node_shard_valid = 0;
+
+/* CPU 所在的节点，由 xf_heap_linux_map_nodes 填写，之后查表不再进入内核 */
+static unsigned char s_cpu_node[XF_HEAP_LINUX_MAX_CPUS];
+static int s_cpu_node_valid = 0;
+
+/* ==================== [Global Functions] ================================== */
+
+int xf_heap_linux_map(xf_heap_region_t *region, unsigned int size, int node, xf_heap_page_t *page)
+{
+    void *addr = MAP_FAILED;
+    size_t length = 0;
+    xf_heap_page_t type = *page;
+
+    if ((size == 0) || (size > LINUX_MAX_SIZE)) {
+        return -1;
+    }
+
+    /* 大页不可用时依次退回透明大页和普通页 */
+    if (type == XF_HEAP_PAGE_HUGETLB) {
+        length = linux_align(size, XF_HEAP_LINUX_HUGE_PAGE_SIZE);
+        addr = linux_map_hugetlb(length);
+        if (addr == MAP_FAILED) {
+            type = XF_HEAP_PAGE_TRANSPARENT;
+        }
+    }
+    if (type == XF_HEAP_PAGE_TRANSPARENT) {
+        length = linux_align(size, XF_HEAP_LINUX_HUGE_PAGE_SIZE);
+        addr = linux_map_transparent(length);
+        if (addr == MAP_FAILED) {
+            type = XF_HEAP_PAGE_NORMAL;
+        }
+    }
+    if (type == XF_HEAP_PAGE_NORMAL) {
+        length = linux_align(size, (size_t) sysconf(_SC_PAGESIZE));
+        addr = linux_map_normal(length);
+    }
+    if (addr == MAP_FAILED) {
+        return -1;
+    }
+
+    /* 在首次访问之前绑定节点，物理页才会分配在该节点上 */
+    if (linux_bind(addr, length, node) != 0) {
+        munmap(addr, length);
+        return -1;
+    }
+
+    region->stat_address = addr;
+    region->size_in_bytes = (unsigned int) length;
+    region->zeroed = 1;
+    *page = type;
+
+    return 0;
+}
+
+void xf_heap_linux_unmap(const xf_heap_region_t *region)
+{
+    if ((region->stat_address != NULL) && (region->size_in_bytes != 0)) {
+        munmap(region->stat_address, region->size_in_bytes);
+    }
+}
+
+int xf_heap_linux_map_nodes(xf_heap_region_t *regions, int nodes, unsigned int size, xf_heap_page_t *page)
+{
+    xf_heap_region_t region;
+    xf_heap_page_t type = *page;
+    unsigned char online[XF_HEAP_LINUX_MAX_NODES];
+    int node_of[XF_HEAP_LINUX_MAX_NODES];
+    int index, pos, node;
+
+    if ((nodes <= 0) || (nodes > XF_HEAP_LINUX_MAX_NODES) || (size > LINUX_MAX_SIZE)) {
+        return -1;
+    }
+
+    /* 在线节点的编号可能不连续，没有 NUMA 时只有节点0 */
+    if (linux_read_list("/sys/devices/system/node/online", online, XF_HEAP_LINUX_MAX_NODES) <= 0) {
+        online[0] = 1;
+    }
+
+    /* 统一按大页对齐，保证各节点的区域大小相同，分片时正好一个节点一个分片 */
+    size = (unsigned int) linux_align(size, XF_HEAP_LINUX_HUGE_PAGE_SIZE);
+
+    for (index = 0, node = 0; index < nodes; index++, node++) {
+        while ((node < XF_HEAP_LINUX_MAX_NODES) && (online[node] == 0)) {
+            node++;
+        }
+        type = *page;
+        if ((node >= XF_HEAP_LINUX_MAX_NODES) || (xf_heap_linux_map(&region, size, node, &type) != 0)) {
+            for (pos = 0; pos < index; pos++) {
+                xf_heap_linux_unmap(&regions[pos]);
+            }
+            return -1;
+        }
+
+        /* 按地址插入排序，xf_heap_init 要求区域地址递增 */
+        for (pos = index; (pos > 0) && (regions[pos - 1].stat_address > region.stat_address); pos--) {
+            regions[pos] = regions[pos - 1];
+            node_of[pos] = node_of[pos - 1];
+        }
+        regions[pos] = region;
+        node_of[pos] = node;
+    }
+    regions[nodes].stat_address = NULL;
+    regions[nodes].size_in_bytes = 0;
+    regions[nodes].zeroed = 0;
+
+    for (pos = 0; pos < nodes; pos++) {
+        node = node_of[pos];
+        s_node_shard[node] = (unsigned int) pos;
+    }
+    s_node_shard_valid = 1;
+    linux_map_cpus();
+    *page = type;
+
+    return 0;
+}
+
+int xf_heap_linux_get_nodes(void)
+{
+    unsigned char online[XF_HEAP_LINUX_MAX_NODES];
+    int count;
+
+    /* 格式形如 "0-1,3"，只统计编号小于 XF_HEAP_LINUX_MAX_NODES 的节点 */
+    count = linux_read_list("/sys/devices/system/node/online", online, XF_HEAP_LINUX_MAX_NODES);
+
+    return (count <= 0) ? 1 : count;
+}
+
+int xf_heap_linux_get_node(void)
+{
+    unsigned int cpu = 0, node = 0;
+    int current;
+
+    /* sched_getcpu 经过 vDSO，查表得到节点 */
+    if (s_cpu_node_valid) {
+        current = sched_getcpu();
+        if ((current >= 0) && (current < XF_HEAP_LINUX_MAX_CPUS)) {
+            return s_cpu_node[current];
+        }
+    }
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 29))
+    if (getcpu(&cpu, &node) != 0) {
+        return 0;
+    }
+#else
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+        return 0;
+    }
+#endif
+
+    return (int) node;
+}
+
+unsigned int xf_heap_linux_shard_id(void)
+{
+    int node = xf_heap_linux_get_node();
+
+    if ((node < 0) || (node >= XF_HEAP_LINUX_MAX_NODES)) {
+        return 0;
+    }
+
+    return s_node_shard_valid ? s_node_shard[node] : (unsigned int) node;
+}
+
+/* ==================== [Static Functions] ================================== */
+
+/**
+ * @brief 向上对齐
+ *
+ * @param size 大小
+ * @param align 对齐字节数，2的幂
+ * @return size_t 对齐后的大小
+ */
+static size_t linux_align(size_t size, size_t align)
+{
+    return (size + align - 1) & ~(align - 1);
+}
+
+/**
+ * @brief 使用预留大页映射内存，系统未预留大页时失败
+ *
+ * @param length 映射大小，大页对齐
+ * @return void* 映射地址，失败返回 MAP_FAILED
+ */
+static void *linux_map_hugetlb(size_t length)
+{
+#ifdef MAP_HUGETLB
+    return mmap(NULL, length, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#else
+    (void) length;
+    return MAP_FAILED;
+#endif
+}
+
+/**
+ * @brief 映射大页对齐的内存并建议内核使用透明大页
+ *      @note 多映射一个大页再裁掉首尾，使起始地址按大页对齐
+ *
+ * @param length 映射大小，大页对齐
+ * @return void* 映射地址，透明大页不可用时返回 MAP_FAILED
+ */
+static void *linux_map_transparent(size_t length)
+{
+#ifdef MADV_HUGEPAGE
+    unsigned char *addr, *aligned;
+    size_t head;
+
+    /* 透明大页关闭时 madvise 仍然成功，但不会得到大页 */
+    if (!linux_transparent_enabled()) {
+        return MAP_FAILED;
+    }
+
+    addr = mmap(NULL, length + XF_HEAP_LINUX_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *) addr == MAP_FAILED) {
+        return MAP_FAILED;
+    }
+
+    aligned = (unsigned char *) linux_align((size_t) addr, XF_HEAP_LINUX_HUGE_PAGE_SIZE);
+    head = (size_t)(aligned - addr);
+    if (head != 0) {
+        munmap(addr, head);
+    }
+    munmap(aligned + length, XF_HEAP_LINUX_HUGE_PAGE_SIZE - head);
+
+    if (madvise(aligned, length, MADV_HUGEPAGE) != 0) {
+        munmap(aligned, length);
+        return MAP_FAILED;
+    }
+
+    return aligned;
+#else
+    (void) length;
+    return MAP_FAILED;
+#endif
+}
+
+/**
+ * @brief 映射普通页内存，并建议内核不使用透明大页
+ *      @note 透明大页的全局开关为 always 时，普通映射也会被合并为大页
+ *
+ * @param length 映射大小，页对齐
+ * @return void* 映射地址，失败时返回 MAP_FAILED
+ */
+static void *linux_map_normal(size_t length)
+{
+    void *addr;
+
+    addr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_NOHUGEPAGE
+    /* 内核不支持透明大页时返回 EINVAL，此时本来就只有普通页 */
+    if (addr != MAP_FAILED) {
+        (void) madvise(addr, length, MADV_NOHUGEPAGE);
+    }
+#endif
+
+    return addr;
+}
+
+/**
+ * @brief 读取透明大页的全局开关
+ *
+ * @return int 开关为 always 或 madvise 时返回1，为 never 或内核不支持时返回0
+ */
+static int linux_transparent_enabled(void)
+{
+    char buf[64];
+    ssize_t len;
+    int fd;
+
+    /* 格式形如 "always [madvise] never"，方括号内为当前模式 */
+    fd = open("/sys/kernel/mm/transparent_hugepage/enabled", O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return 0;
+    }
+    buf[len] = '\0';
+
+    return (strstr(buf, "[never]") == NULL) ? 1 : 0;
+}
+
+/**
+ * @brief 将内存绑定到 NUMA 节点，内核不支持 NUMA 时忽略
+ *
+ * @param addr 内存地址
+ * @param length 内存大小
+ * @param node 节点编号，小于0表示不绑定
+ * @return int 成功或不绑定返回0，绑定失败返回-1
+ */
+static int linux_bind(void *addr, size_t length, int node)
+{
+    unsigned long mask[(XF_HEAP_LINUX_MAX_NODES + LINUX_MASK_BITS - 1) / LINUX_MASK_BITS] = {0};
+
+    if (node < 0) {
+        return 0;
+    }
+    if (node >= XF_HEAP_LINUX_MAX_NODES) {
+        return -1;
+    }
+
+    mask[node / LINUX_MASK_BITS] = 1UL << (node % LINUX_MASK_BITS);
+    if (syscall(SYS_mbind, addr, length, LINUX_MPOL_BIND, mask,
+                (unsigned long) XF_HEAP_LINUX_MAX_NODES + 1, 0) != 0) {
+        return (errno == ENOSYS) ? 0 : -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 读取 sysfs 中形如 "0-3,8" 的编号列表
+ *
+ * @param path 文件路径
+ * @param set 输出，列表中的编号对应项置1，其余置0
+ * @param max set 的大小，超出的编号忽略
+ * @return int 置1的编号个数，读取失败返回-1
+ */
+static int linux_read_list(const char *path, unsigned char *set, int max)
+{
+    char buf[1024];
+    ssize_t len;
+    int fd, index, first = -1, value = -1, count = 0;
+
+    for (index = 0; index < max; index++) {
+        set[index] = 0;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+
+    for (index = 0; index <= len; index++) {
+        if ((buf[index] >= '0') && (buf[index] <= '9')) {
+            value = ((value < 0) ? 0 : value * 10) + (buf[index] - '0');
+            continue;
+        }
+        if ((buf[index] == '-') && (value >= 0)) {
+            first = value;
+            value = -1;
+            continue;
+        }
+        /* 逗号、换行或结尾结束一段编号 */
+        if (value >= 0) {
+            if (first < 0) {
+                first = value;
+            }
+            for (; (first <= value) && (first < max); first++) {
+                if (set[first] == 0) {
+                    set[first] = 1;
+                    count++;
+                }
+            }
+        }
+        first = -1;
+        value = -1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief 根据各节点的 cpulist 建立 CPU 到节点的映射表
+ *
+ */
+static void linux_map_cpus(void)
+{
+    unsigned char cpus[XF_HEAP_LINUX_MAX_CPUS];
+    char path[64];
+    int node, cpu;
+
+    for (cpu = 0; cpu < XF_HEAP_LINUX_MAX_CPUS; cpu++) {
+        s_cpu_node[cpu] = 0;
+    }
+
+    for (node = 0; node < XF_HEAP_LINUX_MAX_NODES; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (linux_read_list(path, cpus, XF_HEAP_LINUX_MAX_CPUS) <= 0) {
+            continue;
+        }
+        for (cpu = 0; cpu < XF_HEAP_LINUX_MAX_CPUS; cpu++) {
+            if (cpus[cpu] != 0) {
+                s_cpu_node[cpu] = (unsigned char) node;
+            }
+        }
+    }
+    s_cpu_node_valid = 1;
+}
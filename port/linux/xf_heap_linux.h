@@ -0,0 +1,112 @@
+/**
+ * @file xf_heap_linux.h
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief Linux 下的内存区域提供者，支持大页和 NUMA 节点绑定
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#ifndef __XF_HEAP_LINUX_H__
+#define __XF_HEAP_LINUX_H__
+
+/* ==================== [Includes] ========================================== */
+
+#include "xf_heap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==================== [Defines] =========================================== */
+
+/* 支持的 NUMA 节点数上限 */
+#ifndef XF_HEAP_LINUX_MAX_NODES
+#define XF_HEAP_LINUX_MAX_NODES 16
+#endif
+
+/* 支持的 CPU 数上限，编号更大的 CPU 通过 getcpu 获取节点 */
+#ifndef XF_HEAP_LINUX_MAX_CPUS
+#define XF_HEAP_LINUX_MAX_CPUS 1024
+#endif
+
+/* ==================== [Typedefs] ========================================== */
+
+/**
+ * @brief 内存区域的页类型
+ *
+ */
+typedef enum _xf_heap_page_t {
+    XF_HEAP_PAGE_NORMAL = 0,        /*!< 普通页，MADV_NOHUGEPAGE */
+    XF_HEAP_PAGE_TRANSPARENT,       /*!< 透明大页，MADV_HUGEPAGE */
+    XF_HEAP_PAGE_HUGETLB,           /*!< 预留大页，MAP_HUGETLB */
+} xf_heap_page_t;
+
+/* ==================== [Global Prototypes] ================================= */
+
+/**
+ * @brief 映射一块内存区域
+ *      @note 按 HUGETLB、TRANSPARENT、NORMAL 的顺序从 page 开始依次尝试，
+ *      实际使用的页类型写回 page，透明大页全局关闭（never）时视为不可用。
+ *      映射的内存全为0，region->zeroed 置1
+ *
+ * @param region 输出的内存区域，可直接用于 xf_heap_init
+ * @param size 内存大小，会向上对齐到页大小，需小于1GB
+ * @param node 绑定的 NUMA 节点，小于0表示不绑定，内核不支持 NUMA 时忽略
+ * @param page 期望的页类型，输出实际使用的页类型
+ * @return int 成功返回0，映射或绑定节点失败返回-1
+ */
+int xf_heap_linux_map(xf_heap_region_t *region, unsigned int size, int node, xf_heap_page_t *page);
+
+/**
+ * @brief 解除映射 xf_heap_linux_map 映射的内存区域
+ *
+ * @param region 内存区域
+ */
+void xf_heap_linux_unmap(const xf_heap_region_t *region);
+
+/**
+ * @brief 为每个 NUMA 节点映射一块内存区域，按地址排序后写入 regions
+ *      @note 配合 XF_HEAP_SHARD_NUM 等于节点数、XF_HEAP_SHARD_ID 为 xf_heap_linux_shard_id()
+ *      使用时，每个分片正好对应一个节点，xf_malloc 优先从本地节点申请。
+ *      各节点的区域大小之和需小于4GB
+ *
+ * @param regions 输出的内存区域数组，至少 nodes + 1 个，以 {NULL, 0} 结尾
+ * @param nodes 节点数，一般为 xf_heap_linux_get_nodes()，依次使用编号最小的 nodes 个在线节点
+ * @param size 每个节点的内存大小
+ * @param page 期望的页类型，输出最后一个区域实际使用的页类型
+ * @return int 成功返回0，在线节点不足或任一节点映射失败时返回-1并解除已映射的区域
+ */
+int xf_heap_linux_map_nodes(xf_heap_region_t *regions, int nodes, unsigned int size, xf_heap_page_t *page);
+
+/**
+ * @brief 获取在线的 NUMA 节点数，节点编号可能不连续
+ *
+ * @return int 节点数，没有 NUMA 时为1
+ */
+int xf_heap_linux_get_nodes(void);
+
+/**
+ * @brief 获取当前线程所在 CPU 的 NUMA 节点
+ *      @note 调用 xf_heap_linux_map_nodes 之后通过 sched_getcpu 查表，不进入内核
+ *
+ * @return int 节点编号
+ */
+int xf_heap_linux_get_node(void);
+
+/**
+ * @brief 获取当前节点对应的分片编号，用作 XF_HEAP_SHARD_ID
+ *
+ * @return unsigned int 分片编号，未调用 xf_heap_linux_map_nodes 时返回节点编号
+ */
+unsigned int xf_heap_linux_shard_id(void);
+
+/* ==================== [Macros] ============================================ */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif // __XF_HEAP_LINUX_H__
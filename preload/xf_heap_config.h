@@ -0,0 +1,11 @@
+#include <stdint.h>
+#include <pthread.h>
+
+/* 静态初始化的互斥锁，在构造函数执行之前也可以使用 */
+extern pthread_mutex_t xf_heap_preload_lock;
+#define XF_HEAP_LOCK_PTR (&xf_heap_preload_lock)
+#define XF_HEAP_LOCK(PLOCK) pthread_mutex_lock((pthread_mutex_t *)(PLOCK))
+#define XF_HEAP_UNLOCK(PLOCK) pthread_mutex_unlock((pthread_mutex_t *)(PLOCK))
+
+/* 与 glibc malloc 保持一致的16字节对齐 */
+#define XF_HEAP_BYTE_ALIGNMENT 16
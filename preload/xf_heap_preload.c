@@ -0,0 +1,293 @@
+/**
+ * @file xf_heap_preload.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief 通过 LD_PRELOAD 用 xf_heap 替换 glibc 的 malloc 系列函数
+ *      @note 首次申请时用 mmap 映射一整块内存注册给 xf_heap，之后的申请释放都由 xf_heap 完成。
+ *      用法：LD_PRELOAD=libxf_heap_preload.so ./app
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+/* ==================== [Includes] ========================================== */
+
+#include <errno.h>
+#include <malloc.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "xf_heap.h"
+#include "xf_alloc.h"
+
+/* ==================== [Defines] =========================================== */
+
+/* 对齐申请的标记依赖已占用内存块的 next_free_block，紧凑内存块头没有该字段 */
+#if XF_HEAP_COMPACT_HEADER
+#error "xf_heap_preload does not support XF_HEAP_COMPACT_HEADER"
+#endif
+
+/* mmap 映射的堆大小，按需分配物理页，不占用实际内存 */
+#ifndef PRELOAD_HEAP_SIZE
+#define PRELOAD_HEAP_SIZE       (1u << 30)
+#endif
+
+/* 单次申请的上限，内存块大小的高两位被用作标志 */
+#define PRELOAD_MAX_SIZE        ((size_t)(1u << 30) - 1024)
+
+/* 对齐申请的标记，放在普通内存块 next_free_block 所在的位置，普通内存块此处恒为 (void*) 0 */
+#define PRELOAD_ALIGNED_MAGIC   ((void *)(uintptr_t)0xA11CA7EDu)
+
+/* ==================== [Macros] ============================================ */
+
+/* 用户指针之前 XF_HEAP_BYTE_ALIGNMENT 字节处为内存块结构体的 next_free_block，对齐申请在此写入标记 */
+#define PRELOAD_MAGIC_SLOT(ptr) (*(void **)((unsigned char *)(ptr) - XF_HEAP_BYTE_ALIGNMENT))
+
+/* 对齐申请在用户指针之前记录原始指针 */
+#define PRELOAD_RAW_SLOT(ptr)   (((void **)(ptr))[-1])
+
+/* ==================== [Static Prototypes] ================================= */
+
+static int preload_init(void);
+static void *preload_malloc(size_t size);
+static void *preload_memalign(size_t alignment, size_t size);
+static void *preload_raw(void *ptr);
+
+/* ==================== [Static Variables] ================================== */
+
+static pthread_mutex_t s_init_lock = PTHREAD_MUTEX_INITIALIZER;
+static int s_inited = 0;
+
+/* ==================== [Global Variables] ================================== */
+
+pthread_mutex_t xf_heap_preload_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* ==================== [Global Functions] ================================== */
+
+void *malloc(size_t size)
+{
+    return preload_malloc(size);
+}
+
+void free(void *ptr)
+{
+    xf_free(preload_raw(ptr));
+}
+
+void *calloc(size_t num, size_t size)
+{
+    void *ptr;
+
+    if ((size != 0) && (num > PRELOAD_MAX_SIZE / size)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if ((num == 0) || (size == 0)) {
+        return preload_malloc(0);
+    }
+    if (!preload_init()) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    /* mmap 的内存已知全为0，xf_calloc 只清零复用过的内存块 */
+    ptr = xf_calloc((unsigned int) num, (unsigned int) size);
+    if (ptr == NULL) {
+        errno = ENOMEM;
+    }
+
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    void *new_ptr;
+    size_t usable;
+
+    if (ptr == NULL) {
+        return preload_malloc(size);
+    }
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+
+    usable = malloc_usable_size(ptr);
+    if (size <= usable) {
+        return ptr;
+    }
+
+    new_ptr = preload_malloc(size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, usable);
+        free(ptr);
+    }
+
+    return new_ptr;
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    void *ptr;
+
+    if ((alignment < sizeof(void *)) || ((alignment & (alignment - 1)) != 0)) {
+        return EINVAL;
+    }
+
+    ptr = preload_memalign(alignment, size);
+    if (ptr == NULL) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+
+    return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    if ((alignment == 0) || ((alignment & (alignment - 1)) != 0)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    return preload_memalign(alignment, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    return aligned_alloc(alignment, size);
+}
+
+void *valloc(size_t size)
+{
+    return preload_memalign((size_t) sysconf(_SC_PAGESIZE), size);
+}
+
+void *pvalloc(size_t size)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+
+    if (size > PRELOAD_MAX_SIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return preload_memalign(page, (size + page - 1) & ~(page - 1));
+}
+
+size_t malloc_usable_size(void *ptr)
+{
+    void *raw = preload_raw(ptr);
+
+    if (ptr == NULL) {
+        return 0;
+    }
+
+    return xf_heap_get_usable_size(raw) - (size_t)((unsigned char *) ptr - (unsigned char *) raw);
+}
+
+/* ==================== [Static Functions] ================================== */
+
+/**
+ * @brief 首次调用时映射内存并初始化 xf_heap
+ *      @note 动态链接器和其他库的构造函数可能早于本库申请内存，因此不能依赖构造函数初始化
+ *
+ * @return int 初始化成功返回非0
+ */
+static int preload_init(void)
+{
+    xf_heap_region_t regions[2] = {0};
+    void *heap;
+
+    if (__atomic_load_n(&s_inited, __ATOMIC_ACQUIRE)) {
+        return 1;
+    }
+
+    pthread_mutex_lock(&s_init_lock);
+    if (!s_inited) {
+        heap = mmap(NULL, PRELOAD_HEAP_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (heap != MAP_FAILED) {
+            regions[0].stat_address = heap;
+            regions[0].size_in_bytes = PRELOAD_HEAP_SIZE;
+            regions[0].zeroed = 1;
+            xf_heap_init(regions);
+            __atomic_store_n(&s_inited, 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&s_init_lock);
+
+    return s_inited;
+}
+
+/**
+ * @brief 申请内存，0字节的申请按1字节处理，保证返回唯一的指针
+ *
+ * @param size 申请内存的大小
+ * @return void* 申请内存地址，失败时设置 errno
+ */
+static void *preload_malloc(size_t size)
+{
+    void *ptr = NULL;
+
+    if ((size <= PRELOAD_MAX_SIZE) && preload_init()) {
+        ptr = xf_malloc((size == 0) ? 1 : (unsigned int) size);
+    }
+    if (ptr == NULL) {
+        errno = ENOMEM;
+    }
+
+    return ptr;
+}
+
+/**
+ * @brief 申请对齐的内存
+ *      @note 多申请 alignment 字节，在对齐地址之前记录标记和原始指针
+ *
+ * @param alignment 对齐字节数，2的幂
+ * @param size 申请内存的大小
+ * @return void* 申请内存地址
+ */
+static void *preload_memalign(size_t alignment, size_t size)
+{
+    unsigned char *raw;
+    void *ptr;
+
+    if (alignment <= XF_HEAP_BYTE_ALIGNMENT) {
+        return preload_malloc(size);
+    }
+    if ((size > PRELOAD_MAX_SIZE) || (alignment > PRELOAD_MAX_SIZE - size)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    raw = preload_malloc(size + alignment);
+    if (raw == NULL) {
+        return NULL;
+    }
+
+    /* xf_heap 返回的地址已按 XF_HEAP_BYTE_ALIGNMENT 对齐，对齐后至少留出 XF_HEAP_BYTE_ALIGNMENT 字节记录信息 */
+    ptr = (void *)(((uintptr_t) raw + alignment) & ~(uintptr_t)(alignment - 1));
+    PRELOAD_MAGIC_SLOT(ptr) = PRELOAD_ALIGNED_MAGIC;
+    PRELOAD_RAW_SLOT(ptr) = raw;
+
+    return ptr;
+}
+
+/**
+ * @brief 获取 xf_heap 申请的原始指针
+ *
+ * @param ptr 用户指针
+ * @return void* 对齐申请返回原始指针，否则原样返回
+ */
+static void *preload_raw(void *ptr)
+{
+    if ((ptr != NULL) && (PRELOAD_MAGIC_SLOT(ptr) == PRELOAD_ALIGNED_MAGIC)) {
+        return PRELOAD_RAW_SLOT(ptr);
+    }
+
+    return ptr;
+}
@@ -24,186 +24,481 @@
 /* 内存块最小所需的空间大小 */
 #define MINIMUM_BLOCK_SIZE  ((unsigned int) (heap_struct_size << 1))
 
+/* 空闲内存块的最大大小，次高位为清零标志，更大的内存区域注册时切割为多个内存块，合并时不超过该大小 */
+#define MAXIMUM_BLOCK_SIZE  ((block_zeroed_bit - 1) & ~((unsigned int) BYTE_ALIGNMENT_MASK))
+
+/* 分片时单个内存片段的最小大小，至少容纳对齐损耗、结束标志和一个最小内存块 */
+#define MINIMUM_SHARD_SIZE  ((unsigned int) (MINIMUM_BLOCK_SIZE + heap_link_size + XF_HEAP_BYTE_ALIGNMENT))
+
+#if XF_HEAP_COMPACT_HEADER
+/* 紧凑模式下表示 (void*) 0 的偏移 */
+#define COMPACT_NULL        (~0u)
+#endif
+
 /* ==================== [Typedefs] ========================================== */
 
+#if XF_HEAP_COMPACT_HEADER
+/* 已占用的内存块只保留 block_size，next_free_block 仅在空闲时有效，位于用户区开头 */
+typedef struct _block_link_t {
+    unsigned int block_size;                /*!< 当前区块的大小 */
+    unsigned int next_free_block;           /*!< 下一个区块相对 base 的偏移 */
+} block_link_t;
+#else
 typedef struct _block_link_t {
     struct _block_link_t *next_free_block;  /*!< 下一个区块的位置 */
     unsigned int block_size;                      /*!< 当前区块的大小 */
 } block_link_t;
+#endif
+
+typedef struct _alloc_heap_t {
+    /**
+     * @brief 闲内存块链表的起点和终点。
+     * 用户在注册的时候末尾 next_free_block 为 (void*) 0，block_size 为 0
+     *
+     * @note 注意：这里终点是指针。
+     */
+    block_link_t start, *end;
+#if XF_HEAP_COMPACT_HEADER
+    unsigned char *base;                /*!< 第一块注册内存的起始地址，空闲链表偏移的基准 */
+#endif
+#if XF_HEAP_QUICK_LIST_ENABLE
+    block_link_t *quick_list[XF_HEAP_QUICK_LIST_NUM]; /*!< 按内存块大小分类的快速链表，链表内的内存块空闲但未合并 */
+    unsigned int quick_list_count;      /*!< 快速链表内暂存的内存块总数 */
+#endif
+#if XF_HEAP_STATS_ENABLE
+    unsigned int search_count;          /*!< 上一次申请访问的空闲链表节点数 */
+#endif
+} alloc_heap_t;
 
 /* ==================== [Static Prototypes] ================================= */
 
-static void insert_block_into_free_list(block_link_t *block_to_insert);
+static void *heap_malloc(alloc_heap_t *heap, unsigned int size);
+static void *heap_calloc(alloc_heap_t *heap, unsigned int size);
+static void *heap_malloc_hint(alloc_heap_t *heap, unsigned int size, xf_heap_lifetime_t hint);
+static void heap_free(alloc_heap_t *heap, void *pv);
+static void heap_reset(alloc_heap_t *heap);
+static unsigned int heap_add_region(alloc_heap_t *heap, xf_heap_intptr_t address,
+                                    unsigned int size, unsigned int zeroed);
+static void insert_block_into_free_list(alloc_heap_t *heap, block_link_t *block_to_insert);
+static unsigned int align_block_size(unsigned int size);
+static block_link_t *take_free_block(alloc_heap_t *heap, unsigned int size);
+static block_link_t *take_free_block_high(alloc_heap_t *heap, unsigned int size);
+static block_link_t *malloc_block(alloc_heap_t *heap, unsigned int size);
+static unsigned int merge_block_size(block_link_t *low, block_link_t *high);
+static void clear_memory(void *pv, unsigned int size);
+#if XF_HEAP_QUICK_LIST_ENABLE
+static block_link_t *quick_list_pop(alloc_heap_t *heap, unsigned int size);
+static int quick_list_push(alloc_heap_t *heap, block_link_t *block);
+static void quick_list_flush(alloc_heap_t *heap);
+#endif
 
 /* ==================== [Static Variables] ================================== */
 
-/* 计算内存块结构体占用大小，并内存对齐 */
+/* 计算已占用内存块头部占用大小，并内存对齐 */
+#if XF_HEAP_COMPACT_HEADER
+static const unsigned int heap_struct_size =
+    (sizeof(unsigned int)
+     + ((unsigned int)(XF_HEAP_BYTE_ALIGNMENT - 1))) & ~((unsigned int)BYTE_ALIGNMENT_MASK);
+#else
 static const unsigned int heap_struct_size =
     (sizeof(block_link_t)
      + ((unsigned int)(XF_HEAP_BYTE_ALIGNMENT - 1))) & ~((unsigned int)BYTE_ALIGNMENT_MASK);
+#endif
+
+/* 计算空闲内存块结构体占用大小，并内存对齐，紧凑模式下会占用用户区开头 */
+static const unsigned int heap_link_size =
+    (sizeof(block_link_t)
+     + ((unsigned int)(XF_HEAP_BYTE_ALIGNMENT - 1))) & ~((unsigned int)BYTE_ALIGNMENT_MASK);
 
 /* 内存块大小的最高位掩码，最高位用于检测内存块是否为空闲 */
 static const unsigned int block_allocate_bit = ((unsigned int) 1) << ((sizeof(unsigned int) * 8) - 1);
 
-/**
- * @brief 闲内存块链表的起点和终点。
- * 用户在注册的时候末尾 next_free_block 为 (void*) 0，block_size 为 0
- *
- * @note 注意：这里终点是指针。
- */
-static block_link_t start, *end = (void *)0;
+/* 空闲内存块大小的次高位掩码，置位表示该内存块的用户区已知全为0 */
+static const unsigned int block_zeroed_bit = ((unsigned int) 1) << ((sizeof(unsigned int) * 8) - 2);
+
+/* 已占用内存块大小的次高位掩码，置位表示该内存块被采样内存分析记录，与清零标志共用同一位 */
+static const unsigned int block_sampled_bit = ((unsigned int) 1) << ((sizeof(unsigned int) * 8) - 2);
+
+/* 已占用内存块大小中记录标签的位，紧接在清零标志之下 */
+#if XF_HEAP_TAG_ENABLE
+static const unsigned int block_tag_shift = (sizeof(unsigned int) * 8) - 2 - XF_HEAP_TAG_BITS;
+static const unsigned int block_tag_mask =
+    ((((unsigned int) 1) << XF_HEAP_TAG_BITS) - 1) << ((sizeof(unsigned int) * 8) - 2 - XF_HEAP_TAG_BITS);
+#else
+static const unsigned int block_tag_shift = 0;
+static const unsigned int block_tag_mask = 0;
+#endif
+
+/* 各分片的空闲链表，未开启分片时只有 heaps[0] */
+static alloc_heap_t heaps[XF_HEAP_SHARD_NUM];
 
 /* ==================== [Macros] ============================================ */
 
+/* 空闲链表中内存块的实际大小，去掉清零标志 */
+#define FREE_BLOCK_SIZE(block) ((block)->block_size & ~block_zeroed_bit)
+
+#if XF_HEAP_COMPACT_HEADER
+/* 空闲链表中的下一个内存块 */
+#define NEXT_FREE_BLOCK(heap, block) \
+    (((block)->next_free_block == COMPACT_NULL) ? (block_link_t *) 0 \
+     : (block_link_t *)((heap)->base + (block)->next_free_block))
+
+/* 设置空闲链表中的下一个内存块 */
+#define SET_NEXT_FREE_BLOCK(heap, block, next) \
+    ((block)->next_free_block = ((next) == (void*) 0) ? COMPACT_NULL \
+     : (unsigned int)((unsigned char *)(next) - (heap)->base))
+
+/* 内存块是否已被占用 */
+#define BLOCK_IS_ALLOCATED(block) (((block)->block_size & block_allocate_bit) != 0)
+
+/* 将取出的空闲内存块标记为占用 */
+#define BLOCK_SET_ALLOCATED(block) ((block)->block_size = FREE_BLOCK_SIZE(block) | block_allocate_bit)
+#else
+#define NEXT_FREE_BLOCK(heap, block) ((block)->next_free_block)
+#define SET_NEXT_FREE_BLOCK(heap, block, next) ((block)->next_free_block = (next))
+#define BLOCK_IS_ALLOCATED(block) \
+    ((((block)->block_size & block_allocate_bit) != 0) && ((block)->next_free_block == (void*) 0))
+#define BLOCK_SET_ALLOCATED(block) \
+    ((block)->block_size = FREE_BLOCK_SIZE(block) | block_allocate_bit, (block)->next_free_block = (void*) 0)
+#endif
+
+#if XF_HEAP_QUICK_LIST_ENABLE
+/* 内存块大小对应的快速链表下标，超出 XF_HEAP_QUICK_LIST_NUM 的不进入快速链表 */
+#define QUICK_LIST_INDEX(block_size) \
+    ((((block_size) - heap_struct_size) / XF_HEAP_BYTE_ALIGNMENT) - 1)
+#endif
+
 /* ==================== [Global Functions] ================================== */
 
 void *xf_heap_malloc(unsigned int size)
 {
-    block_link_t *block, *previous_block, *new_block_link;
-    void *ret = (void*) 0;
+    return heap_malloc(&heaps[0], size);
+}
 
-    XF_HEAP_ASSERT(end);
+void *xf_heap_calloc(unsigned int size)
+{
+    return heap_calloc(&heaps[0], size);
+}
 
-    if ((size & block_allocate_bit) == 0) {
-        /* 申请内存大小进行对齐 */
-        if ((size > 0) && ((size + heap_struct_size) > size)) {
-            size += heap_struct_size;
+void *xf_heap_malloc_hint(unsigned int size, xf_heap_lifetime_t hint)
+{
+    return heap_malloc_hint(&heaps[0], size, hint);
+}
 
-            if ((size & BYTE_ALIGNMENT_MASK) != 0x00) {
-                if ((size + (XF_HEAP_BYTE_ALIGNMENT - (size & BYTE_ALIGNMENT_MASK))) > size) {
-                    size += (XF_HEAP_BYTE_ALIGNMENT - (size & BYTE_ALIGNMENT_MASK));
-                } else {
-                    size = 0;
-                }
-            }
-        } else {
-            size = 0;
-        }
+void xf_heap_free(void *pv)
+{
+    heap_free(&heaps[0], pv);
+}
 
-        /**
-         * 内存剩余足够，则切割成已使用内存块和更小的空闲内存块，
-         *  空闲内存块插入空闲内存块链表
-         */
-        if ((size > 0)) {
-            previous_block = &start;
-            block = start.next_free_block;
-
-            while ((block->block_size < size) && (block->next_free_block != (void*) 0)) {
-                previous_block = block;
-                block = block->next_free_block;
-            }
+unsigned int xf_heap_region(const xf_heap_region_t *const heap_regions)
+{
+    unsigned int total_heap_size = 0;
+    const xf_heap_region_t *heap_region = heap_regions;
 
-            if (block != end) {
-                ret = (void *)(((unsigned char *) previous_block->next_free_block) + heap_struct_size);
+    heap_reset(&heaps[0]);
 
-                previous_block->next_free_block = block->next_free_block;
+    /* 循环将heap_regions内的内存分别注册进空闲内存块链表里  */
+    while (heap_region->size_in_bytes > 0) {
+        total_heap_size += heap_add_region(&heaps[0], (xf_heap_intptr_t) heap_region->stat_address,
+                                           heap_region->size_in_bytes, heap_region->zeroed);
+        heap_region++;
+    }
 
-                if ((block->block_size - size) > MINIMUM_BLOCK_SIZE) {
-                    new_block_link = (void *)((unsigned char *) block + size);
+    XF_HEAP_ASSERT(total_heap_size);
 
-                    new_block_link->block_size = block->block_size - size;
-                    block->block_size = size;
+    return total_heap_size;
+}
 
-                    insert_block_into_free_list((new_block_link));
-                }
+unsigned int xf_heap_get_block_size(void *pv)
+{
+    unsigned int block_size = 0;
+    unsigned char *puc = (unsigned char *) pv;
+    block_link_t *link;
 
-                block->block_size |= block_allocate_bit;
-                block->next_free_block = (void*) 0;
-            }
+    if (pv != (void*) 0) {
+        puc -= heap_struct_size;
+
+        link = (void *) puc;
+
+        if (BLOCK_IS_ALLOCATED(link)) {
+            block_size = link->block_size & ~(block_allocate_bit | block_sampled_bit | block_tag_mask);
+            return block_size;
         }
     }
+    return 0;
+}
 
-    return ret;
+void xf_heap_set_tag(void *pv, unsigned int tag)
+{
+    block_link_t *link;
+
+    if (pv != (void*) 0) {
+        link = (void *)(((unsigned char *) pv) - heap_struct_size);
+
+        if (BLOCK_IS_ALLOCATED(link)) {
+            link->block_size = (link->block_size & ~block_tag_mask) | ((tag << block_tag_shift) & block_tag_mask);
+        }
+    }
 }
 
-void xf_heap_free(void *pv)
+unsigned int xf_heap_get_tag(void *pv)
 {
-    unsigned char *puc = (unsigned char *) pv;
     block_link_t *link;
 
     if (pv != (void*) 0) {
-        puc -= heap_struct_size;
+        link = (void *)(((unsigned char *) pv) - heap_struct_size);
 
-        link = (void *) puc;
+        if (BLOCK_IS_ALLOCATED(link)) {
+            return (link->block_size & block_tag_mask) >> block_tag_shift;
+        }
+    }
+    return 0;
+}
+
+void xf_heap_set_sampled(void *pv)
+{
+    block_link_t *link;
 
-        XF_HEAP_ASSERT((link->block_size & block_allocate_bit) != 0);
-        XF_HEAP_ASSERT(link->next_free_block == (void*) 0);
+    if (pv != (void*) 0) {
+        link = (void *)(((unsigned char *) pv) - heap_struct_size);
 
-        if ((link->block_size & block_allocate_bit) != 0) {
-            if (link->next_free_block == (void*) 0) {
-                link->block_size &= ~block_allocate_bit;
-                insert_block_into_free_list(((block_link_t *) link));
-            }
+        if (BLOCK_IS_ALLOCATED(link)) {
+            link->block_size |= block_sampled_bit;
         }
     }
 }
 
-unsigned int xf_heap_region(const xf_heap_region_t *const heap_regions)
+unsigned int xf_heap_is_sampled(void *pv)
+{
+    block_link_t *link;
+
+    if (pv != (void*) 0) {
+        link = (void *)(((unsigned char *) pv) - heap_struct_size);
+
+        if (BLOCK_IS_ALLOCATED(link)) {
+            return ((link->block_size & block_sampled_bit) != 0) ? 1 : 0;
+        }
+    }
+    return 0;
+}
+
+unsigned int xf_heap_get_usable_size(void *pv)
+{
+    unsigned int block_size = xf_heap_get_block_size(pv);
+
+    if (block_size == 0) {
+        return 0;
+    }
+
+    return block_size - heap_struct_size;
+}
+
+unsigned int xf_heap_get_search_count(void)
+{
+#if XF_HEAP_STATS_ENABLE
+    return heaps[0].search_count;
+#else
+    return 0;
+#endif
+}
+
+#if XF_HEAP_SHARD_NUM > 1
+
+unsigned int xf_heap_shard_region(const xf_heap_region_t *const heap_regions)
 {
-    block_link_t *first_free_block_in_region = (void*) 0, *previous_free_block;
-    xf_heap_intptr_t aligned_heap;
-    unsigned int total_region_size, total_heap_size = 0;
-    long defined_regions = 0;
-    xf_heap_intptr_t address;
     const xf_heap_region_t *heap_region;
+    unsigned int total_size = 0, total_heap_size = 0;
+    unsigned int shard_size, remaining, size, piece;
+    unsigned int shard = 0;
+    xf_heap_intptr_t address;
 
-    XF_HEAP_ASSERT(end == (void*) 0);
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        heap_reset(&heaps[shard]);
+    }
 
-    heap_region = &(heap_regions[defined_regions]);
+    for (heap_region = heap_regions; heap_region->size_in_bytes > 0; heap_region++) {
+        total_size += heap_region->size_in_bytes;
+    }
 
-    /* 循环将heap_regions内的内存分别注册进空闲内存块链表里  */
-    while (heap_region->size_in_bytes > 0) {
-        total_region_size = heap_region->size_in_bytes;
+    /* 按地址顺序把内存切成大小相近的连续片段，依次分给各个分片 */
+    shard = 0;
+    shard_size = total_size / XF_HEAP_SHARD_NUM;
+    remaining = shard_size;
 
+    for (heap_region = heap_regions; heap_region->size_in_bytes > 0; heap_region++) {
         address = (xf_heap_intptr_t) heap_region->stat_address;
+        size = heap_region->size_in_bytes;
+
+        while (size > 0) {
+            piece = size;
+            if ((shard < (XF_HEAP_SHARD_NUM - 1)) && (size > remaining)) {
+                if (remaining < MINIMUM_SHARD_SIZE) {
+                    shard++;
+                    remaining = shard_size;
+                    continue;
+                }
+                piece = remaining & ~BYTE_ALIGNMENT_MASK;
+                /* 剩余部分太小则不再切割 */
+                if ((size - piece) < MINIMUM_SHARD_SIZE) {
+                    piece = size;
+                }
+            }
 
-        if ((address & BYTE_ALIGNMENT_MASK) != 0) {
-            address += (XF_HEAP_BYTE_ALIGNMENT - 1);
-            address &= ~BYTE_ALIGNMENT_MASK;
+            if (piece >= MINIMUM_SHARD_SIZE) {
+                total_heap_size += heap_add_region(&heaps[shard], address, piece, heap_region->zeroed);
+            }
 
-            total_region_size -= address - (xf_heap_intptr_t) heap_region->stat_address;
+            address += piece;
+            size -= piece;
+            if ((piece >= remaining) && (shard < (XF_HEAP_SHARD_NUM - 1))) {
+                shard++;
+                remaining = shard_size;
+            } else if (piece < remaining) {
+                remaining -= piece;
+            }
         }
+    }
 
-        aligned_heap = address;
+    XF_HEAP_ASSERT(total_heap_size);
 
-        if (defined_regions == 0) {
-            start.next_free_block = (block_link_t *) aligned_heap;
-            start.block_size = (unsigned int) 0;
-        } else {
-            XF_HEAP_ASSERT(end != (void*) 0);
-            XF_HEAP_ASSERT(address > (unsigned int) end);
+    return total_heap_size;
+}
+
+void *xf_heap_shard_malloc(unsigned int shard, unsigned int size)
+{
+    return heap_malloc(&heaps[shard], size);
+}
+
+void *xf_heap_shard_calloc(unsigned int shard, unsigned int size)
+{
+    return heap_calloc(&heaps[shard], size);
+}
+
+void *xf_heap_shard_malloc_hint(unsigned int shard, unsigned int size, xf_heap_lifetime_t hint)
+{
+    return heap_malloc_hint(&heaps[shard], size, hint);
+}
+
+void xf_heap_shard_free(unsigned int shard, void *pv)
+{
+    heap_free(&heaps[shard], pv);
+}
+
+unsigned int xf_heap_shard_of(void *pv)
+{
+    unsigned int shard;
+
+    /* 各分片的内存按地址递增排列，第一个结束地址大于 pv 的分片即为所属分片 */
+    for (shard = 0; shard < (XF_HEAP_SHARD_NUM - 1); shard++) {
+        if ((heaps[shard].end != (void*) 0) && ((unsigned char *) pv < (unsigned char *) heaps[shard].end)) {
+            break;
         }
+    }
 
-        previous_free_block = end;
-        address = aligned_heap + total_region_size;
-        address -= heap_struct_size;
-        address &= ~BYTE_ALIGNMENT_MASK;
-        end = (block_link_t *) address;
-        end->block_size = 0;
-        end->next_free_block = (void*) 0;
+    return shard;
+}
+
+unsigned int xf_heap_shard_get_search_count(unsigned int shard)
+{
+#if XF_HEAP_STATS_ENABLE
+    return heaps[shard].search_count;
+#else
+    (void) shard;
+    return 0;
+#endif
+}
+
+#endif
+
+/* ==================== [Static Functions] ================================== */
+
+static void *heap_malloc(alloc_heap_t *heap, unsigned int size)
+{
+    block_link_t *block;
+    void *ret = (void*) 0;
+
+    if (heap->end == (void*) 0) {
+        return (void*) 0;
+    }
 
-        first_free_block_in_region = (block_link_t *) aligned_heap;
-        first_free_block_in_region->block_size = address - (xf_heap_intptr_t) first_free_block_in_region;
-        first_free_block_in_region->next_free_block = end;
+    block = malloc_block(heap, size);
 
-        if (previous_free_block != (void*) 0) {
-            previous_free_block->next_free_block = first_free_block_in_region;
+    if (block != (void*) 0) {
+        ret = (void *)(((unsigned char *) block) + heap_struct_size);
+        BLOCK_SET_ALLOCATED(block);
+    }
+
+    return ret;
+}
+
+static void *heap_calloc(alloc_heap_t *heap, unsigned int size)
+{
+    block_link_t *block;
+    unsigned int zeroed;
+    void *ret = (void*) 0;
+
+    if (heap->end == (void*) 0) {
+        return (void*) 0;
+    }
+
+    block = malloc_block(heap, size);
+
+    if (block != (void*) 0) {
+        ret = (void *)(((unsigned char *) block) + heap_struct_size);
+        zeroed = block->block_size & block_zeroed_bit;
+        BLOCK_SET_ALLOCATED(block);
+
+        /* 已知全为0的内存块不需要再清零，紧凑模式下只需清除空闲内存块结构体占用的用户区开头 */
+        if (zeroed == 0) {
+            clear_memory(ret, (block->block_size & ~block_allocate_bit) - heap_struct_size);
+        } else if (heap_link_size > heap_struct_size) {
+            clear_memory(ret, heap_link_size - heap_struct_size);
         }
+    }
+
+    return ret;
+}
 
-        total_heap_size += first_free_block_in_region->block_size;
+static void *heap_malloc_hint(alloc_heap_t *heap, unsigned int size, xf_heap_lifetime_t hint)
+{
+    block_link_t *block;
+    void *ret = (void*) 0;
 
-        defined_regions++;
-        heap_region = &(heap_regions[defined_regions]);
+    if (heap->end == (void*) 0) {
+        return (void*) 0;
     }
 
-    XF_HEAP_ASSERT(total_heap_size);
+    if (hint != XF_HEAP_LIFETIME_LONG) {
+        return heap_malloc(heap, size);
+    }
 
-    return total_heap_size;
+#if XF_HEAP_STATS_ENABLE
+    heap->search_count = 0;
+#endif
+
+    size = align_block_size(size);
+
+    if ((size > 0)) {
+        /* 长生命周期不复用快速链表，避免落在低地址的短生命周期内存之间 */
+        block = take_free_block_high(heap, size);
+#if XF_HEAP_QUICK_LIST_ENABLE
+        if ((block == (void*) 0) && (heap->quick_list_count != 0)) {
+            quick_list_flush(heap);
+            block = take_free_block_high(heap, size);
+        }
+#endif
+
+        if (block != (void*) 0) {
+            ret = (void *)(((unsigned char *) block) + heap_struct_size);
+            BLOCK_SET_ALLOCATED(block);
+        }
+    }
+
+    return ret;
 }
 
-unsigned int xf_heap_get_block_size(void *pv)
+static void heap_free(alloc_heap_t *heap, void *pv)
 {
-    unsigned int block_size = 0;
     unsigned char *puc = (unsigned char *) pv;
     block_link_t *link;
 
@@ -212,53 +507,453 @@ unsigned int xf_heap_get_block_size(void *pv)
 
         link = (void *) puc;
 
-        if ((link->block_size & block_allocate_bit) != 0) {
-            if (link->next_free_block == (void*) 0) {
-                block_size = link->block_size & (~block_allocate_bit);
-                return block_size;
+        XF_HEAP_ASSERT(BLOCK_IS_ALLOCATED(link));
+
+        if (BLOCK_IS_ALLOCATED(link)) {
+            link->block_size &= ~(block_allocate_bit | block_sampled_bit | block_tag_mask);
+#if XF_HEAP_QUICK_LIST_ENABLE
+            if (quick_list_push(heap, link) != 0) {
+                return;
             }
+#endif
+            insert_block_into_free_list(heap, ((block_link_t *) link));
         }
     }
-    return 0;
 }
 
+/**
+ * @brief 清空空闲链表，允许反初始化之后重新注册内存
+ *
+ * @param heap 空闲链表
+ */
+static void heap_reset(alloc_heap_t *heap)
+{
+#if XF_HEAP_QUICK_LIST_ENABLE
+    unsigned int index;
+#endif
+
+    heap->end = (void*) 0;
+#if XF_HEAP_COMPACT_HEADER
+    heap->base = (void*) 0;
+#endif
+    SET_NEXT_FREE_BLOCK(heap, &heap->start, (void*) 0);
+    heap->start.block_size = (unsigned int) 0;
+#if XF_HEAP_QUICK_LIST_ENABLE
+    for (index = 0; index < XF_HEAP_QUICK_LIST_NUM; index++) {
+        heap->quick_list[index] = (void*) 0;
+    }
+    heap->quick_list_count = 0;
+#endif
+}
 
-/* ==================== [Static Functions] ================================== */
+/**
+ * @brief 将一块内存注册进空闲链表末尾，需要按地址从低到高注册
+ *
+ * @param heap 空闲链表
+ * @param address 内存起始地址
+ * @param size 内存大小
+ * @param zeroed 非0表示内存已全部清零
+ * @return unsigned int 可用内存大小，紧凑模式下超出第一块内存之后 4GB 的区域不注册，返回0
+ */
+static unsigned int heap_add_region(alloc_heap_t *heap, xf_heap_intptr_t address,
+                                    unsigned int size, unsigned int zeroed)
+{
+    block_link_t *first_free_block_in_region, *previous_free_block, *block;
+    xf_heap_intptr_t aligned_heap;
+    unsigned int total_region_size = size;
+    unsigned int remaining, block_size;
+
+    if ((address & BYTE_ALIGNMENT_MASK) != 0) {
+        aligned_heap = address + (XF_HEAP_BYTE_ALIGNMENT - 1);
+        aligned_heap &= ~BYTE_ALIGNMENT_MASK;
+
+        total_region_size -= aligned_heap - address;
+    } else {
+        aligned_heap = address;
+    }
+
+    address = aligned_heap + total_region_size;
+    address -= heap_link_size;
+    address &= ~BYTE_ALIGNMENT_MASK;
+
+    if (heap->end == (void*) 0) {
+#if XF_HEAP_COMPACT_HEADER
+        heap->base = (unsigned char *) aligned_heap;
+#endif
+        SET_NEXT_FREE_BLOCK(heap, &heap->start, (block_link_t *) aligned_heap);
+        heap->start.block_size = (unsigned int) 0;
+    } else {
+        XF_HEAP_ASSERT(aligned_heap > (xf_heap_intptr_t) heap->end);
+#if XF_HEAP_COMPACT_HEADER
+        /* 空闲链表使用相对 base 的32位偏移，超出 base 之后 4GB 的内存区域不注册 */
+        if ((unsigned long long)(address - (xf_heap_intptr_t) heap->base)
+                >= (unsigned long long) COMPACT_NULL) {
+            return 0;
+        }
+#endif
+    }
+
+    previous_free_block = heap->end;
+    heap->end = (block_link_t *) address;
+    heap->end->block_size = 0;
+    SET_NEXT_FREE_BLOCK(heap, heap->end, (void*) 0);
+
+    first_free_block_in_region = (block_link_t *) aligned_heap;
+    total_region_size = address - aligned_heap;
+
+    /* 超过 MAXIMUM_BLOCK_SIZE 的内存区域切割为多个相连的空闲内存块，最后一块不小于 MINIMUM_BLOCK_SIZE */
+    block = first_free_block_in_region;
+    remaining = total_region_size;
+    while (remaining != 0) {
+        if (remaining <= MAXIMUM_BLOCK_SIZE) {
+            block_size = remaining;
+        } else if ((remaining - MAXIMUM_BLOCK_SIZE) >= MINIMUM_BLOCK_SIZE) {
+            block_size = MAXIMUM_BLOCK_SIZE;
+        } else {
+            block_size = (remaining >> 1) & ~((unsigned int) BYTE_ALIGNMENT_MASK);
+        }
+        remaining -= block_size;
+
+        block->block_size = block_size;
+        if (zeroed != 0) {
+            block->block_size |= block_zeroed_bit;
+        }
+        if (remaining != 0) {
+            SET_NEXT_FREE_BLOCK(heap, block, (block_link_t *)((unsigned char *) block + block_size));
+            block = NEXT_FREE_BLOCK(heap, block);
+        } else {
+            SET_NEXT_FREE_BLOCK(heap, block, heap->end);
+        }
+    }
+
+    if (previous_free_block != (void*) 0) {
+        SET_NEXT_FREE_BLOCK(heap, previous_free_block, first_free_block_in_region);
+    }
+
+    return total_region_size;
+}
 
 /**
  * @brief 将内存块插入空闲链表中，前后内存连续则进行合并
  *
+ * @param heap 空闲链表
  * @param block_to_insert 空闲内存区域数组，需要结尾为{(void*) 0, 0}为最后一个内存块
  */
-static void insert_block_into_free_list(block_link_t *block_to_insert)
+static void insert_block_into_free_list(alloc_heap_t *heap, block_link_t *block_to_insert)
 {
-    block_link_t *iterator;
+    block_link_t *iterator, *next_block;
     unsigned char *puc;
 
-    for (iterator = &start; iterator->next_free_block < block_to_insert; iterator = iterator->next_free_block) {
+    for (iterator = &heap->start; NEXT_FREE_BLOCK(heap, iterator) < block_to_insert;
+            iterator = NEXT_FREE_BLOCK(heap, iterator)) {
     }
 
     puc = (unsigned char *) iterator;
 
-    if ((puc + iterator->block_size) == (unsigned char *) block_to_insert) {
-        iterator->block_size += block_to_insert->block_size;
+    /* 合并后超过 MAXIMUM_BLOCK_SIZE 时保持为相邻的两个内存块 */
+    if (((puc + FREE_BLOCK_SIZE(iterator)) == (unsigned char *) block_to_insert)
+            && ((FREE_BLOCK_SIZE(iterator) + FREE_BLOCK_SIZE(block_to_insert)) <= MAXIMUM_BLOCK_SIZE)) {
+        iterator->block_size = merge_block_size(iterator, block_to_insert);
         block_to_insert = iterator;
     }
 
     puc = (unsigned char *) block_to_insert;
 
-    if ((puc + block_to_insert->block_size) == (unsigned char *) iterator->next_free_block) {
-        if (iterator->next_free_block != end) {
-            block_to_insert->block_size += iterator->next_free_block->block_size;
-            block_to_insert->next_free_block = iterator->next_free_block->next_free_block;
+    next_block = NEXT_FREE_BLOCK(heap, iterator);
+
+    if (((puc + FREE_BLOCK_SIZE(block_to_insert)) == (unsigned char *) next_block)
+            && ((FREE_BLOCK_SIZE(block_to_insert) + FREE_BLOCK_SIZE(next_block)) <= MAXIMUM_BLOCK_SIZE)) {
+        if (next_block != heap->end) {
+            SET_NEXT_FREE_BLOCK(heap, block_to_insert, NEXT_FREE_BLOCK(heap, next_block));
+            block_to_insert->block_size = merge_block_size(block_to_insert, next_block);
         } else {
-            block_to_insert->next_free_block = end;
+            SET_NEXT_FREE_BLOCK(heap, block_to_insert, heap->end);
         }
     } else {
-        block_to_insert->next_free_block = iterator->next_free_block;
+        SET_NEXT_FREE_BLOCK(heap, block_to_insert, next_block);
     }
 
     if (iterator != block_to_insert) {
-        iterator->next_free_block = block_to_insert;
+        SET_NEXT_FREE_BLOCK(heap, iterator, block_to_insert);
     }
 }
+
+/**
+ * @brief 申请内存大小加上内存块结构体大小后进行对齐
+ *
+ * @param size 申请内存的大小
+ * @return unsigned int 对齐后的内存块大小，溢出或为0时返回0
+ */
+static unsigned int align_block_size(unsigned int size)
+{
+    if ((size & (block_allocate_bit | block_zeroed_bit)) != 0) {
+        return 0;
+    }
+
+    if ((size > 0) && ((size + heap_struct_size) > size)) {
+        size += heap_struct_size;
+
+        if ((size & BYTE_ALIGNMENT_MASK) != 0x00) {
+            if ((size + (XF_HEAP_BYTE_ALIGNMENT - (size & BYTE_ALIGNMENT_MASK))) > size) {
+                size += (XF_HEAP_BYTE_ALIGNMENT - (size & BYTE_ALIGNMENT_MASK));
+            } else {
+                size = 0;
+            }
+        }
+    } else {
+        size = 0;
+    }
+
+    /* 紧凑模式下内存块释放后需要放下空闲内存块结构体 */
+    if ((size != 0) && (size < heap_link_size)) {
+        size = heap_link_size;
+    }
+
+#if XF_HEAP_TAG_ENABLE
+    /* 已占用内存块的大小不能覆盖标签位，未切割的内存块最多比申请大 MINIMUM_BLOCK_SIZE */
+    if (size >= (((unsigned int) 1) << block_tag_shift) - MINIMUM_BLOCK_SIZE) {
+        size = 0;
+    }
+#endif
+
+    return size;
+}
+
+/**
+ * @brief 从空闲链表中找到首个足够大的内存块并摘下，剩余部分足够大则切割后重新插入
+ *
+ * @param heap 空闲链表
+ * @param size 对齐后的内存块大小（包含内存块结构体）
+ * @return block_link_t* 摘下的内存块，没有足够大的内存块返回 (void*) 0
+ */
+static block_link_t *take_free_block(alloc_heap_t *heap, unsigned int size)
+{
+    block_link_t *block, *previous_block, *new_block_link;
+
+    previous_block = &heap->start;
+    block = NEXT_FREE_BLOCK(heap, &heap->start);
+#if XF_HEAP_STATS_ENABLE
+    heap->search_count++;
+#endif
+
+    while ((FREE_BLOCK_SIZE(block) < size) && (NEXT_FREE_BLOCK(heap, block) != (void*) 0)) {
+        previous_block = block;
+        block = NEXT_FREE_BLOCK(heap, block);
+#if XF_HEAP_STATS_ENABLE
+        heap->search_count++;
+#endif
+    }
+
+    if (block == heap->end) {
+        return (void*) 0;
+    }
+
+    SET_NEXT_FREE_BLOCK(heap, previous_block, NEXT_FREE_BLOCK(heap, block));
+
+    if ((FREE_BLOCK_SIZE(block) - size) > MINIMUM_BLOCK_SIZE) {
+        new_block_link = (void *)((unsigned char *) block + size);
+
+        /* 切割出的两部分沿用原内存块的清零标志 */
+        new_block_link->block_size = block->block_size - size;
+        block->block_size = size | (block->block_size & block_zeroed_bit);
+
+        insert_block_into_free_list(heap, (new_block_link));
+    }
+
+    return block;
+}
+
+/**
+ * @brief 从空闲链表中找到地址最高的足够大的内存块，从其尾部切割
+ *      @note 切割后前半部分仍留在空闲链表原位，无需重新插入
+ *
+ * @param heap 空闲链表
+ * @param size 对齐后的内存块大小（包含内存块结构体）
+ * @return block_link_t* 切割出的内存块，没有足够大的内存块返回 (void*) 0
+ */
+static block_link_t *take_free_block_high(alloc_heap_t *heap, unsigned int size)
+{
+    block_link_t *block, *previous_block;
+    block_link_t *found = (void*) 0, *found_previous = (void*) 0;
+
+    previous_block = &heap->start;
+    block = NEXT_FREE_BLOCK(heap, &heap->start);
+
+    while (block != heap->end) {
+#if XF_HEAP_STATS_ENABLE
+        heap->search_count++;
+#endif
+        if (FREE_BLOCK_SIZE(block) >= size) {
+            found = block;
+            found_previous = previous_block;
+        }
+        previous_block = block;
+        block = NEXT_FREE_BLOCK(heap, block);
+    }
+
+    if (found == (void*) 0) {
+        return (void*) 0;
+    }
+
+    if ((FREE_BLOCK_SIZE(found) - size) > MINIMUM_BLOCK_SIZE) {
+        found->block_size -= size;
+        block = (void *)((unsigned char *) found + FREE_BLOCK_SIZE(found));
+        block->block_size = size | (found->block_size & block_zeroed_bit);
+    } else {
+        SET_NEXT_FREE_BLOCK(heap, found_previous, NEXT_FREE_BLOCK(heap, found));
+        block = found;
+    }
+
+    return block;
+}
+
+/**
+ * @brief 按申请大小取出一个空闲内存块，优先使用快速链表
+ *
+ * @param heap 空闲链表
+ * @param size 申请内存的大小
+ * @return block_link_t* 取出的内存块，保留清零标志，尚未标记为占用
+ */
+static block_link_t *malloc_block(alloc_heap_t *heap, unsigned int size)
+{
+    block_link_t *block = (void*) 0;
+
+#if XF_HEAP_STATS_ENABLE
+    heap->search_count = 0;
+#endif
+
+    size = align_block_size(size);
+
+    if ((size > 0)) {
+#if XF_HEAP_QUICK_LIST_ENABLE
+        block = quick_list_pop(heap, size);
+        if (block == (void*) 0) {
+            block = take_free_block(heap, size);
+        }
+        if ((block == (void*) 0) && (heap->quick_list_count != 0)) {
+            /* 空闲链表无法满足，合并快速链表后再尝试一次 */
+            quick_list_flush(heap);
+            block = take_free_block(heap, size);
+        }
+#else
+        block = take_free_block(heap, size);
+#endif
+    }
+
+    return block;
+}
+
+/**
+ * @brief 计算相邻的两个空闲内存块合并后的大小
+ *      @note 两者都已清零时，将高地址内存块的结构体也清零，合并后仍保持清零标志
+ *
+ * @param low 低地址的内存块
+ * @param high 高地址的内存块，紧接在 low 之后
+ * @return unsigned int 合并后的 block_size，包含清零标志
+ */
+static unsigned int merge_block_size(block_link_t *low, block_link_t *high)
+{
+    unsigned int size = FREE_BLOCK_SIZE(low) + FREE_BLOCK_SIZE(high);
+
+    /* 合并内存区域的结束标志不影响清零状态 */
+    if (FREE_BLOCK_SIZE(high) == 0) {
+        return low->block_size;
+    }
+
+    if ((low->block_size & high->block_size & block_zeroed_bit) != 0) {
+        clear_memory(high, heap_link_size);
+        size |= block_zeroed_bit;
+    }
+
+    return size;
+}
+
+/**
+ * @brief 将内存清零
+ *
+ * @param pv 内存地址
+ * @param size 内存大小
+ */
+static void clear_memory(void *pv, unsigned int size)
+{
+    unsigned char *puc = (unsigned char *) pv;
+
+    while (size-- > 0) {
+        *puc++ = 0;
+    }
+}
+
+#if XF_HEAP_QUICK_LIST_ENABLE
+
+/**
+ * @brief 从对应大小的快速链表中取出一个内存块
+ *
+ * @param heap 空闲链表
+ * @param size 对齐后的内存块大小（包含内存块结构体）
+ * @return block_link_t* 取出的内存块，快速链表为空返回 (void*) 0
+ */
+static block_link_t *quick_list_pop(alloc_heap_t *heap, unsigned int size)
+{
+    unsigned int index = QUICK_LIST_INDEX(size);
+    block_link_t *block;
+
+    if ((size <= heap_struct_size) || (index >= XF_HEAP_QUICK_LIST_NUM)) {
+        return (void*) 0;
+    }
+
+    block = heap->quick_list[index];
+    if (block != (void*) 0) {
+        heap->quick_list[index] = NEXT_FREE_BLOCK(heap, block);
+        heap->quick_list_count--;
+    }
+
+    return block;
+}
+
+/**
+ * @brief 将已释放的内存块暂存到快速链表，暂存数超过阈值时批量合并
+ *
+ * @param heap 空闲链表
+ * @param block 已清除占用标志的内存块
+ * @return int 1 已暂存，0 大小不符合，需要直接插入空闲链表
+ */
+static int quick_list_push(alloc_heap_t *heap, block_link_t *block)
+{
+    unsigned int index = QUICK_LIST_INDEX(block->block_size);
+
+    if ((block->block_size <= heap_struct_size) || (index >= XF_HEAP_QUICK_LIST_NUM)) {
+        return 0;
+    }
+
+    SET_NEXT_FREE_BLOCK(heap, block, heap->quick_list[index]);
+    heap->quick_list[index] = block;
+    heap->quick_list_count++;
+
+    if (heap->quick_list_count > XF_HEAP_QUICK_LIST_THRESHOLD) {
+        quick_list_flush(heap);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief 将快速链表中的所有内存块合并回空闲链表
+ *
+ * @param heap 空闲链表
+ */
+static void quick_list_flush(alloc_heap_t *heap)
+{
+    block_link_t *block;
+    unsigned int index;
+
+    for (index = 0; index < XF_HEAP_QUICK_LIST_NUM; index++) {
+        while (heap->quick_list[index] != (void*) 0) {
+            block = heap->quick_list[index];
+            heap->quick_list[index] = NEXT_FREE_BLOCK(heap, block);
+            insert_block_into_free_list(heap, block);
+        }
+    }
+    heap->quick_list_count = 0;
+}
+
+#endif
@@ -36,6 +36,23 @@ extern "C" {
  */
 void *xf_heap_malloc(unsigned int size);
 
+/**
+ * @brief 带内存管理的清零内存申请函数，已知全为0的空闲内存块不再重复清零
+ *
+ * @param size 申请内存的大小
+ * @return void* 申请内存地址，内容全为0
+ */
+void *xf_heap_calloc(unsigned int size);
+
+/**
+ * @brief 带生命周期提示的内存申请函数
+ *
+ * @param size 申请内存的大小
+ * @param hint 生命周期提示，长生命周期从最高地址的空闲块尾部切割
+ * @return void* 申请内存地址
+ */
+void *xf_heap_malloc_hint(unsigned int size, xf_heap_lifetime_t hint);
+
 /**
  * @brief 带内存管理的内存释放函数
  *
@@ -59,6 +76,118 @@ unsigned int xf_heap_region(const xf_heap_region_t *const heap_regions);
  */
 unsigned int xf_heap_get_block_size(void *pv);
 
+/**
+ * @brief 获取内存块中用户可用的大小，不小于申请时的大小
+ *
+ * @param pv 内存块指针
+ * @return unsigned int 可用大小，不是已申请的内存块时返回0
+ */
+unsigned int xf_heap_get_usable_size(void *pv);
+
+/**
+ * @brief 获取上一次申请访问的空闲链表节点数
+ *
+ * @return unsigned int 访问的节点数，未开启 XF_HEAP_STATS_ENABLE 时恒为0
+ */
+unsigned int xf_heap_get_search_count(void);
+
+/**
+ * @brief 将标签记录在已申请内存块大小的空闲高位中
+ *
+ * @param pv 内存块指针
+ * @param tag 标签，小于 XF_HEAP_TAG_NUM，未开启 XF_HEAP_TAG_ENABLE 时忽略
+ */
+void xf_heap_set_tag(void *pv, unsigned int tag);
+
+/**
+ * @brief 获取内存块的标签
+ *
+ * @param pv 内存块指针
+ * @return unsigned int 标签，未开启 XF_HEAP_TAG_ENABLE 时恒为0
+ */
+unsigned int xf_heap_get_tag(void *pv);
+
+/**
+ * @brief 将已申请内存块标记为被采样，标记在释放时清除
+ *
+ * @param pv 内存块指针
+ */
+void xf_heap_set_sampled(void *pv);
+
+/**
+ * @brief 判断内存块是否被标记为采样
+ *
+ * @param pv 内存块指针
+ * @return unsigned int 被标记时返回1
+ */
+unsigned int xf_heap_is_sampled(void *pv);
+
+#if XF_HEAP_SHARD_NUM > 1
+
+/**
+ * @brief 分片内存注册，按地址将内存均分为 XF_HEAP_SHARD_NUM 份，依次注册给各个分片
+ *      @note 单次申请只能来自一个分片，即使堆为空，可申请的最大内存也只有总内存的 1/XF_HEAP_SHARD_NUM 左右
+ *      @note 内存过小时靠后的分片可能为空，对空分片申请内存直接返回 (void*) 0
+ *
+ * @param heap_regions 注册内存的数据信息
+ * @return unsigned int 所有分片总共可用内存大小
+ */
+unsigned int xf_heap_shard_region(const xf_heap_region_t *const heap_regions);
+
+/**
+ * @brief 从指定分片申请内存
+ *
+ * @param shard 分片编号
+ * @param size 申请内存的大小
+ * @return void* 申请内存地址
+ */
+void *xf_heap_shard_malloc(unsigned int shard, unsigned int size);
+
+/**
+ * @brief 从指定分片申请清零内存
+ *
+ * @param shard 分片编号
+ * @param size 申请内存的大小
+ * @return void* 申请内存地址，内容全为0
+ */
+void *xf_heap_shard_calloc(unsigned int shard, unsigned int size);
+
+/**
+ * @brief 从指定分片申请带生命周期提示的内存
+ *
+ * @param shard 分片编号
+ * @param size 申请内存的大小
+ * @param hint 生命周期提示
+ * @return void* 申请内存地址
+ */
+void *xf_heap_shard_malloc_hint(unsigned int shard, unsigned int size, xf_heap_lifetime_t hint);
+
+/**
+ * @brief 将内存释放回指定分片，分片需与 xf_heap_shard_of 的结果一致
+ *
+ * @param shard 分片编号
+ * @param pv 需要释放的指针地址
+ */
+void xf_heap_shard_free(unsigned int shard, void *pv);
+
+/**
+ * @brief 获取内存所属的分片
+ *
+ * @param pv 内存块指针
+ * @return unsigned int 分片编号
+ */
+unsigned int xf_heap_shard_of(void *pv);
+
+/**
+ * @brief 获取指定分片上一次申请访问的空闲链表节点数
+ *
+ * @param shard 分片编号
+ * @return unsigned int 访问的节点数，未开启 XF_HEAP_STATS_ENABLE 时恒为0
+ */
+unsigned int xf_heap_shard_get_search_count(unsigned int shard);
+
+#endif
+
 /* ==================== [Macros] ============================================ */
 
 #ifdef __cplusplus
@@ -17,68 +17,272 @@
 
 /* ==================== [Defines] =========================================== */
 
+/* 需要返回清零的内存，内存管理算法已清零时清除 */
+#define MALLOC_ZEROED       (1u << 0)
+
+/* 超出标签的上限，不再向其他分片借用，也不调用回收回调 */
+#define MALLOC_OVER_BUDGET  (1u << 1)
+
+/* 本次申请需要采样，在释放锁之后获取调用栈 */
+#define MALLOC_SAMPLE       (1u << 2)
+
+/* 采样时调用栈中内存管理内部的栈帧数上限，多获取这些栈帧再去掉 */
+#define PROFILER_INTERNAL_DEPTH 4
+
 /* ==================== [Typedefs] ========================================== */
 
+#if XF_HEAP_PROFILER_ENABLE
+typedef struct _profiler_sample_t {
+    void *ptr;                                  /*!< 被采样的内存，(void*) 0 表示空位 */
+    unsigned int weight;                        /*!< 该采样代表的估计字节数 */
+    int depth;                                  /*!< 调用栈深度 */
+    void *frames[XF_HEAP_PROFILER_MAX_DEPTH];   /*!< 调用栈，frames[0] 为最内层 */
+} profiler_sample_t;
+
+typedef struct _profiler_t {
+    long bytes_until_sample;                    /*!< 距离下一次采样剩余的字节数 */
+    unsigned int rand;                          /*!< 随机数状态 */
+    unsigned int live;                          /*!< 未释放的采样数 */
+    unsigned int dropped;                       /*!< 采样记录已满而丢弃的采样数 */
+    profiler_sample_t samples[XF_HEAP_PROFILER_MAX_SAMPLES];
+} profiler_t;
+#endif
+
+#if XF_HEAP_RECLAIM_ENABLE
+typedef struct _reclaim_t {
+    xf_heap_reclaim_cb_t cb;            /*!< 回收回调，(void*) 0 表示空位 */
+    void *ctx;                          /*!< 用户参数 */
+} reclaim_t;
+#endif
+
+#if XF_HEAP_TAG_ENABLE
+typedef struct _tag_t {
+    unsigned int live_bytes;            /*!< 在用字节数 */
+    unsigned int peak_bytes;            /*!< 在用字节数的峰值 */
+    unsigned int count;                 /*!< 在用内存块数 */
+    unsigned int budget;                /*!< 在用字节数上限，0表示不限 */
+} tag_t;
+#endif
+
+typedef struct _heap_shard_t {
+    void *lock;                         /*!< 分片的锁 */
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    void *remote_free_list;             /*!< 非所属线程释放的内存块，无锁单链表 */
+#endif
+#if XF_HEAP_STATS_ENABLE
+    xf_heap_stats_t stats;              /*!< 耗时统计 */
+#endif
+#if XF_HEAP_PROFILER_ENABLE
+    profiler_t profiler;                /*!< 采样内存分析 */
+#endif
+} heap_shard_t;
+
 typedef struct _heap_t {
     xf_alloc_func_t func;
-    void *lock;
     unsigned int init;
     unsigned int free_bytes;
     unsigned int min_ever_free_bytes_remaining;
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    xf_heap_intptr_t owner;             /*!< 所属线程标识 */
+#endif
+#if XF_HEAP_RECLAIM_ENABLE
+    reclaim_t reclaims[XF_HEAP_RECLAIM_NUM]; /*!< 回收回调 */
+    unsigned int low_watermark;         /*!< 低水位 */
+    unsigned int high_watermark;        /*!< 高水位 */
+    xf_heap_watermark_cb_t watermark_cb; /*!< 水位回调 */
+    void *watermark_ctx;                /*!< 水位回调的用户参数 */
+    unsigned int pressure;              /*!< 当前内存压力状态 */
+#endif
+#if XF_HEAP_TAG_ENABLE
+    tag_t tags[XF_HEAP_TAG_NUM];        /*!< 各标签的统计，所有分片共用 */
+#endif
+    heap_shard_t shards[XF_HEAP_SHARD_NUM];
 } heap_t;
 
 /* ==================== [Static Prototypes] ================================= */
 
+static void *heap_malloc(unsigned int size, xf_heap_lifetime_t hint, unsigned int zeroed,
+                         unsigned int tag, void *caller);
+static void *shards_malloc(unsigned int size, xf_heap_lifetime_t hint, unsigned int tag,
+                           unsigned int *flags, unsigned int cycles_start);
+static void *shard_malloc(unsigned int index, unsigned int size, xf_heap_lifetime_t hint,
+                          unsigned int tag, unsigned int *flags, unsigned int cycles_start);
+static void *shard_take(unsigned int index, unsigned int size, xf_heap_lifetime_t hint,
+                        unsigned int tag, unsigned int *flags);
+static void free_bytes_take(unsigned int size);
+static void free_bytes_give(unsigned int size);
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+static void remote_free_push(heap_shard_t *shard, void *pv);
+static void remote_free_drain(unsigned int index);
+#endif
+#if XF_HEAP_RECLAIM_ENABLE
+static unsigned int reclaim_call(unsigned int index, unsigned int size);
+static int watermark_update(unsigned int *free_bytes);
+static void watermark_notify(int pressure, unsigned int free_bytes);
+#endif
+#if XF_HEAP_TAG_ENABLE
+static int tag_over_budget(unsigned int tag, unsigned int size);
+static int tag_take(unsigned int tag, unsigned int size);
+static void tag_give(unsigned int tag, unsigned int size);
+#endif
+#if XF_HEAP_STATS_ENABLE
+static void stats_record(xf_heap_histogram_t *histogram, unsigned int value);
+static unsigned int stats_record_lock(heap_shard_t *shard, unsigned int cycles_start, unsigned int cycles_locked);
+static void stats_record_op(heap_shard_t *shard, xf_heap_histogram_t *histogram,
+                            unsigned int cycles_start, unsigned int cycles_locked);
+static void stats_record_malloc(heap_shard_t *shard, unsigned int size, unsigned int cycles);
+static void stats_merge(xf_heap_histogram_t *histogram, const xf_heap_histogram_t *other);
+static unsigned int stats_size_class(unsigned int size);
+#endif
+#if XF_HEAP_PROFILER_ENABLE
+static void profiler_reset(profiler_t *profiler, unsigned int seed);
+static void profiler_sample(unsigned int index, void *pv, unsigned int size, void *caller);
+static void profiler_untrack(profiler_t *profiler, void *pv);
+static long profiler_next_interval(profiler_t *profiler);
+static unsigned int profiler_format(char *buf, xf_heap_intptr_t value, unsigned int base);
+#endif
+
 /* ==================== [Static Variables] ================================== */
 
 /*初始化默认参数*/
 static heap_t s_heap = {
-    .lock = XF_HEAP_LOCK_PTR,
     .init = 0,
     .free_bytes = 0,
     .min_ever_free_bytes_remaining = 0,
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    .owner = 0,
+#endif
+    .shards[0].lock = XF_HEAP_LOCK_PTR,
     .func = {
         .malloc = xf_heap_malloc,
         .free = xf_heap_free,
         .init = xf_heap_region,
         .get_block_size = xf_heap_get_block_size,
+        .malloc_hint = xf_heap_malloc_hint,
+        .get_search_count = xf_heap_get_search_count,
+        .calloc = xf_heap_calloc,
+        .set_tag = xf_heap_set_tag,
+        .get_tag = xf_heap_get_tag,
+        .set_sampled = xf_heap_set_sampled,
+        .is_sampled = xf_heap_is_sampled,
     }
 };
 
 /* ==================== [Macros] ============================================ */
 
+/* 分片堆直接调用默认内存管理算法的分片接口，否则通过可重定向的函数表 */
+#if XF_HEAP_SHARD_NUM > 1
+#define SHARD_CURRENT()                         ((unsigned int)(XF_HEAP_SHARD_ID()) % XF_HEAP_SHARD_NUM)
+#define SHARD_OF(PV)                            xf_heap_shard_of(PV)
+#define SHARD_INIT(REGIONS)                     xf_heap_shard_region(REGIONS)
+#define SHARD_MALLOC(INDEX, SIZE)               xf_heap_shard_malloc((INDEX), (SIZE))
+#define SHARD_CALLOC(INDEX, SIZE)               xf_heap_shard_calloc((INDEX), (SIZE))
+#define SHARD_MALLOC_HINT(INDEX, SIZE, HINT)    xf_heap_shard_malloc_hint((INDEX), (SIZE), (HINT))
+#define SHARD_FREE(INDEX, PV)                   xf_heap_shard_free((INDEX), (PV))
+#define SHARD_SEARCH_COUNT(INDEX)               xf_heap_shard_get_search_count(INDEX)
+#else
+#define SHARD_CURRENT()                         0u
+#define SHARD_OF(PV)                            ((void)(PV), 0u)
+#define SHARD_INIT(REGIONS)                     s_heap.func.init(REGIONS)
+#define SHARD_MALLOC(INDEX, SIZE)               s_heap.func.malloc(SIZE)
+#define SHARD_CALLOC(INDEX, SIZE)               s_heap.func.calloc(SIZE)
+#define SHARD_MALLOC_HINT(INDEX, SIZE, HINT)    s_heap.func.malloc_hint((SIZE), (HINT))
+#define SHARD_FREE(INDEX, PV)                   s_heap.func.free(PV)
+#define SHARD_SEARCH_COUNT(INDEX)               s_heap.func.get_search_count()
+#endif
+
+/* 调用 xf_malloc 等公开接口的返回地址，采样时以此去掉调用栈中内存管理内部的栈帧 */
+#if XF_HEAP_PROFILER_ENABLE
+#define PROFILER_CALLER()                       XF_HEAP_RETURN_ADDRESS()
+#else
+#define PROFILER_CALLER()                       ((void*) 0)
+#endif
+
+/* 内存管理算法能否标记被采样的内存块，不能标记时每次释放都查找采样记录 */
+#define SAMPLED_MARK_SUPPORTED() \
+    ((s_heap.func.set_sampled != (void*) 0) && (s_heap.func.is_sampled != (void*) 0))
+
+/* 内存块的标签，内存管理算法不支持标签时为0 */
+#define TAG_OF(PV)  ((s_heap.func.get_tag != (void*) 0) ? s_heap.func.get_tag(PV) : 0u)
+
+/* 在用字节数加上 SIZE 后是否超出上限，BUDGET 为0表示不限 */
+#define TAG_OVER_BUDGET(LIVE, SIZE, BUDGET) \
+    (((BUDGET) != 0) && (((SIZE) > (BUDGET)) || ((LIVE) > (BUDGET) - (SIZE))))
+
 /* ==================== [Global Functions] ================================== */
 
 xf_heap_err_t xf_heap_redirect(xf_alloc_func_t func)
 {
+#if XF_HEAP_SHARD_NUM > 1
+    /* 分片依赖默认内存管理算法按地址划分内存 */
+    (void) func;
+    return XF_HEAP_NOT_SUPPORT;
+#else
     if (s_heap.init != XF_HEAP_MAGIC_NUM && func.malloc &&
             func.free && func.init) {
         s_heap.func.malloc = func.malloc;
         s_heap.func.free = func.free;
         s_heap.func.init = func.init;
         s_heap.func.get_block_size = func.get_block_size;
+        s_heap.func.malloc_hint = func.malloc_hint;
+        s_heap.func.get_search_count = func.get_search_count;
+        s_heap.func.calloc = func.calloc;
+        s_heap.func.set_tag = func.set_tag;
+        s_heap.func.get_tag = func.get_tag;
+        s_heap.func.set_sampled = func.set_sampled;
+        s_heap.func.is_sampled = func.is_sampled;
         return XF_HEAP_OK;
     }
     return XF_HEAP_INITED;
+#endif
 }
 
 int xf_heap_init(const xf_heap_region_t *const regions)
 {
     unsigned int total_size = 0;
+    unsigned int index;
 
     if (s_heap.init == XF_HEAP_MAGIC_NUM) {
         return XF_HEAP_INITED;
     }
-    s_heap.init = XF_HEAP_MAGIC_NUM;
-    total_size = s_heap.func.init(regions);
+    total_size = SHARD_INIT(regions);
     s_heap.free_bytes = total_size;
     s_heap.min_ever_free_bytes_remaining = total_size;
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    s_heap.owner = XF_HEAP_THREAD_ID();
+#endif
+#if XF_HEAP_RECLAIM_ENABLE
+    s_heap.pressure = XF_HEAP_PRESSURE_NORMAL;
+#endif
+#if XF_HEAP_TAG_ENABLE
+    /* 上限保留，统计重新开始 */
+    for (index = 0; index < XF_HEAP_TAG_NUM; index++) {
+        s_heap.tags[index].live_bytes = 0;
+        s_heap.tags[index].peak_bytes = 0;
+        s_heap.tags[index].count = 0;
+    }
+#endif
+    for (index = 0; index < XF_HEAP_SHARD_NUM; index++) {
+        s_heap.shards[index].lock = XF_HEAP_SHARD_LOCK_PTR(index);
+#if XF_HEAP_REMOTE_FREE_ENABLE
+        s_heap.shards[index].remote_free_list = (void*) 0;
+#endif
+#if XF_HEAP_PROFILER_ENABLE
+        profiler_reset(&s_heap.shards[index].profiler, index);
+#endif
+    }
+    s_heap.init = XF_HEAP_MAGIC_NUM;
 
     return XF_HEAP_OK;
 }
 
 int xf_heap_uninit(void)
 {
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    unsigned int index;
+#endif
+
     if (s_heap.init != XF_HEAP_MAGIC_NUM) {
         return XF_HEAP_UNINIT;
     }
@@ -86,57 +290,161 @@ int xf_heap_uninit(void)
     s_heap.init = 0;
     s_heap.free_bytes = 0;
     s_heap.min_ever_free_bytes_remaining = 0;
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    for (index = 0; index < XF_HEAP_SHARD_NUM; index++) {
+        s_heap.shards[index].remote_free_list = (void*) 0;
+    }
+#endif
 
     return XF_HEAP_OK;
 }
 
-void *xf_malloc(unsigned int size)
+#if XF_HEAP_REMOTE_FREE_ENABLE
+void xf_heap_set_owner(void)
 {
-    void *res = (void*) 0;
-    XF_HEAP_LOCK(s_heap.lock);
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
     {
-        if (s_heap.init != XF_HEAP_MAGIC_NUM) {
-            return (void*) 0;
-        }
-        res = s_heap.func.malloc(size);
-        if (res != (void*) 0) {
-            s_heap.free_bytes -= s_heap.func.get_block_size(res);
-            if (s_heap.min_ever_free_bytes_remaining > s_heap.free_bytes) {
-                s_heap.min_ever_free_bytes_remaining = s_heap.free_bytes;
-            }
-        }
+        s_heap.owner = XF_HEAP_THREAD_ID();
     }
-    XF_HEAP_UNLOCK(s_heap.lock);
-    return res;
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
 }
+#endif
+
+void *xf_malloc(unsigned int size)
+{
+    return heap_malloc(size, XF_HEAP_LIFETIME_SHORT, 0, 0, PROFILER_CALLER());
+}
+
+void *xf_calloc(unsigned int num, unsigned int size)
+{
+    if ((size != 0) && (num > (~0u / size))) {
+        return (void*) 0;
+    }
+
+    return heap_malloc(num * size, XF_HEAP_LIFETIME_SHORT, 1, 0, PROFILER_CALLER());
+}
+
+void *xf_malloc_hint(unsigned int size, xf_heap_lifetime_t hint)
+{
+    return heap_malloc(size, hint, 0, 0, PROFILER_CALLER());
+}
+
+#if XF_HEAP_TAG_ENABLE
+void *xf_malloc_tagged(unsigned int size, unsigned int tag)
+{
+    if (tag >= XF_HEAP_TAG_NUM) {
+        return (void*) 0;
+    }
+
+    /* 无法记录标签时计入标签0，保证释放时归还到同一个标签 */
+    if ((s_heap.func.set_tag == (void*) 0) || (s_heap.func.get_tag == (void*) 0)) {
+        tag = 0;
+    }
+
+    return heap_malloc(size, XF_HEAP_LIFETIME_SHORT, 0, tag, PROFILER_CALLER());
+}
+#endif
 
 void xf_free(void *pv)
 {
-    XF_HEAP_LOCK(s_heap.lock);
+    heap_shard_t *shard;
+#if XF_HEAP_STATS_ENABLE
+    unsigned int cycles_start, cycles_locked;
+#endif
+#if XF_HEAP_RECLAIM_ENABLE
+    int pressure = -1;
+    unsigned int free_bytes = 0;
+#endif
+    unsigned int index = SHARD_OF(pv);
+
+#if XF_HEAP_SHARD_NUM > 1
+    /* 未初始化时除分片0外的锁尚未设置 */
+    if (s_heap.init != XF_HEAP_MAGIC_NUM) {
+        return;
+    }
+#endif
+    shard = &s_heap.shards[index];
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+#if XF_HEAP_SHARD_NUM > 1
+    /* 释放到其他分片的内存交给该分片下一次申请时归还 */
+    if ((pv != (void*) 0) && (index != SHARD_CURRENT())) {
+#else
+    if ((pv != (void*) 0) && (XF_HEAP_THREAD_ID() != s_heap.owner)) {
+#endif
+        remote_free_push(shard, pv);
+        return;
+    }
+#endif
+
+#if XF_HEAP_STATS_ENABLE
+    cycles_start = XF_HEAP_CYCLES();
+#endif
+
+    XF_HEAP_LOCK(shard->lock);
     {
-        if (s_heap.init != XF_HEAP_MAGIC_NUM) {
-            return;
-        }
-        if (pv != (void*) 0) {
-            s_heap.free_bytes += s_heap.func.get_block_size(pv);
+#if XF_HEAP_STATS_ENABLE
+        cycles_locked = XF_HEAP_CYCLES();
+#endif
+        if (s_heap.init == XF_HEAP_MAGIC_NUM) {
+            if (pv != (void*) 0) {
+                free_bytes_give(s_heap.func.get_block_size(pv));
+#if XF_HEAP_TAG_ENABLE
+                tag_give(TAG_OF(pv), s_heap.func.get_block_size(pv));
+#endif
+#if XF_HEAP_PROFILER_ENABLE
+                profiler_untrack(&shard->profiler, pv);
+#endif
+            }
+            SHARD_FREE(index, pv);
+#if XF_HEAP_RECLAIM_ENABLE
+            pressure = watermark_update(&free_bytes);
+#endif
         }
-        s_heap.func.free(pv);
+#if XF_HEAP_STATS_ENABLE
+        stats_record_op(shard, &shard->stats.free_cycles, cycles_start, cycles_locked);
+#endif
     }
-    XF_HEAP_UNLOCK(s_heap.lock);
+    XF_HEAP_UNLOCK(shard->lock);
+
+#if XF_HEAP_RECLAIM_ENABLE
+    watermark_notify(pressure, free_bytes);
+#endif
 }
 
 unsigned int xf_heap_get_free_size(void)
 {
     unsigned int res = 0;
-    XF_HEAP_LOCK(s_heap.lock);
+#if XF_HEAP_SHARD_NUM > 1
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    unsigned int index;
+#endif
+
+    if (s_heap.init != XF_HEAP_MAGIC_NUM) {
+        return 0;
+    }
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    for (index = 0; index < XF_HEAP_SHARD_NUM; index++) {
+        XF_HEAP_LOCK(s_heap.shards[index].lock);
+        {
+            remote_free_drain(index);
+        }
+        XF_HEAP_UNLOCK(s_heap.shards[index].lock);
+    }
+#endif
+    res = XF_HEAP_ATOMIC_LOAD(&s_heap.free_bytes);
+#else
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
     {
-        if (s_heap.init != XF_HEAP_MAGIC_NUM) {
-            return 0;
+        if (s_heap.init == XF_HEAP_MAGIC_NUM) {
+#if XF_HEAP_REMOTE_FREE_ENABLE
+            remote_free_drain(0);
+#endif
+            res = s_heap.free_bytes;
         }
-
-        res = s_heap.free_bytes;
     }
-    XF_HEAP_UNLOCK(s_heap.lock);
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+#endif
 
     return res;
 }
@@ -144,17 +452,1056 @@ unsigned int xf_heap_get_free_size(void)
 unsigned int xf_heap_get_min_ever_free_size(void)
 {
     unsigned int res = 0;
-    XF_HEAP_LOCK(s_heap.lock);
+#if XF_HEAP_SHARD_NUM > 1
+    if (s_heap.init == XF_HEAP_MAGIC_NUM) {
+        res = XF_HEAP_ATOMIC_LOAD(&s_heap.min_ever_free_bytes_remaining);
+    }
+#else
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
     {
-        if (s_heap.init != XF_HEAP_MAGIC_NUM) {
-            return 0;
+        if (s_heap.init == XF_HEAP_MAGIC_NUM) {
+            res = s_heap.min_ever_free_bytes_remaining;
         }
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+#endif
 
-        res = s_heap.min_ever_free_bytes_remaining;
+    return res;
+}
+
+#if XF_HEAP_RECLAIM_ENABLE
+xf_heap_err_t xf_heap_register_reclaim(xf_heap_reclaim_cb_t cb, void *ctx)
+{
+    xf_heap_err_t res = XF_HEAP_FULL;
+    unsigned int index;
+
+    if (cb == (void*) 0) {
+        return XF_HEAP_INVALID_ARG;
     }
-    XF_HEAP_UNLOCK(s_heap.lock);
+
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
+    {
+        for (index = 0; index < XF_HEAP_RECLAIM_NUM; index++) {
+            if (s_heap.reclaims[index].cb == (void*) 0) {
+                s_heap.reclaims[index].cb = cb;
+                s_heap.reclaims[index].ctx = ctx;
+                res = XF_HEAP_OK;
+                break;
+            }
+        }
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
 
     return res;
 }
 
+xf_heap_err_t xf_heap_unregister_reclaim(xf_heap_reclaim_cb_t cb, void *ctx)
+{
+    xf_heap_err_t res = XF_HEAP_INVALID_ARG;
+    unsigned int index;
+
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
+    {
+        for (index = 0; index < XF_HEAP_RECLAIM_NUM; index++) {
+            if ((s_heap.reclaims[index].cb == cb) && (s_heap.reclaims[index].ctx == ctx)) {
+                s_heap.reclaims[index].cb = (void*) 0;
+                s_heap.reclaims[index].ctx = (void*) 0;
+                res = XF_HEAP_OK;
+                break;
+            }
+        }
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+
+    return res;
+}
+
+xf_heap_err_t xf_heap_set_watermark(unsigned int low, unsigned int high,
+                                    xf_heap_watermark_cb_t cb, void *ctx)
+{
+    if (high < low) {
+        return XF_HEAP_INVALID_ARG;
+    }
+
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
+    {
+        s_heap.low_watermark = (cb != (void*) 0) ? low : 0;
+        s_heap.high_watermark = (cb != (void*) 0) ? high : 0;
+        s_heap.watermark_cb = cb;
+        s_heap.watermark_ctx = ctx;
+        s_heap.pressure = XF_HEAP_PRESSURE_NORMAL;
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+
+    return XF_HEAP_OK;
+}
+
+xf_heap_pressure_t xf_heap_get_pressure(void)
+{
+#if XF_HEAP_SHARD_NUM > 1
+    return (xf_heap_pressure_t) XF_HEAP_ATOMIC_LOAD(&s_heap.pressure);
+#else
+    return (xf_heap_pressure_t) s_heap.pressure;
+#endif
+}
+#endif
+
+#if XF_HEAP_TAG_ENABLE
+xf_heap_err_t xf_heap_set_tag_budget(unsigned int tag, unsigned int budget)
+{
+    if (tag >= XF_HEAP_TAG_NUM) {
+        return XF_HEAP_INVALID_ARG;
+    }
+
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
+    {
+        s_heap.tags[tag].budget = budget;
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+
+    return XF_HEAP_OK;
+}
+
+xf_heap_err_t xf_heap_get_tag_stats(unsigned int tag, xf_heap_tag_stats_t *stats)
+{
+    tag_t *entry;
+
+    if ((tag >= XF_HEAP_TAG_NUM) || (stats == (void*) 0)) {
+        return XF_HEAP_INVALID_ARG;
+    }
+    entry = &s_heap.tags[tag];
+
+#if XF_HEAP_SHARD_NUM > 1
+    stats->live_bytes = XF_HEAP_ATOMIC_LOAD(&entry->live_bytes);
+    stats->peak_bytes = XF_HEAP_ATOMIC_LOAD(&entry->peak_bytes);
+    stats->count = XF_HEAP_ATOMIC_LOAD(&entry->count);
+    stats->budget = XF_HEAP_ATOMIC_LOAD(&entry->budget);
+#else
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
+    {
+        stats->live_bytes = entry->live_bytes;
+        stats->peak_bytes = entry->peak_bytes;
+        stats->count = entry->count;
+        stats->budget = entry->budget;
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+#endif
+
+    return XF_HEAP_OK;
+}
+#endif
+
+#if XF_HEAP_STATS_ENABLE
+void xf_heap_get_stats(xf_heap_stats_t *stats)
+{
+    heap_shard_t *shard;
+    unsigned int index, size_class;
+
+    if (stats == (void*) 0) {
+        return;
+    }
+
+    /* 各分片的统计依次累加 */
+    *stats = (xf_heap_stats_t) {0};
+    for (index = 0; index < XF_HEAP_SHARD_NUM; index++) {
+        shard = &s_heap.shards[index];
+        XF_HEAP_LOCK(shard->lock);
+        {
+            stats_merge(&stats->malloc_cycles, &shard->stats.malloc_cycles);
+            stats_merge(&stats->free_cycles, &shard->stats.free_cycles);
+            for (size_class = 0; size_class < XF_HEAP_STATS_SIZE_CLASSES; size_class++) {
+                stats_merge(&stats->malloc_size_cycles[size_class], &shard->stats.malloc_size_cycles[size_class]);
+            }
+            stats_merge(&stats->lock_wait_cycles, &shard->stats.lock_wait_cycles);
+            stats_merge(&stats->lock_hold_cycles, &shard->stats.lock_hold_cycles);
+            stats_merge(&stats->search_nodes, &shard->stats.search_nodes);
+        }
+        XF_HEAP_UNLOCK(shard->lock);
+    }
+}
+
+void xf_heap_reset_stats(void)
+{
+    unsigned int index;
+
+    for (index = 0; index < XF_HEAP_SHARD_NUM; index++) {
+        XF_HEAP_LOCK(s_heap.shards[index].lock);
+        {
+            s_heap.shards[index].stats = (xf_heap_stats_t) {0};
+        }
+        XF_HEAP_UNLOCK(s_heap.shards[index].lock);
+    }
+}
+#endif
+
+#if XF_HEAP_PROFILER_ENABLE
+unsigned int xf_heap_profiler_dump(xf_heap_profiler_output_t output, void *arg)
+{
+    char line[XF_HEAP_PROFILER_MAX_DEPTH * (sizeof(void *) * 2 + 3) + 16];
+    profiler_sample_t *sample;
+    heap_shard_t *shard;
+    unsigned int shard_index, index, len;
+    unsigned int dropped = 0;
+    int depth;
+
+    if (output == (void*) 0) {
+        return 0;
+    }
+
+    for (shard_index = 0; shard_index < XF_HEAP_SHARD_NUM; shard_index++) {
+        shard = &s_heap.shards[shard_index];
+        XF_HEAP_LOCK(shard->lock);
+#if XF_HEAP_REMOTE_FREE_ENABLE
+        /* 释放到其他分片的内存仍在释放队列中，先归还以免输出已释放的采样 */
+        if (s_heap.init == XF_HEAP_MAGIC_NUM) {
+            remote_free_drain(shard_index);
+        }
+#endif
+        for (index = 0; index < XF_HEAP_PROFILER_MAX_SAMPLES; index++) {
+            sample = &shard->profiler.samples[index];
+            if (sample->ptr == (void*) 0) {
+                continue;
+            }
+
+            len = 0;
+            if (sample->depth == 0) {
+                len += profiler_format(&line[len], 0, 16);
+            }
+            for (depth = sample->depth - 1; depth >= 0; depth--) {
+                len += profiler_format(&line[len], (xf_heap_intptr_t) sample->frames[depth], 16);
+                if (depth != 0) {
+                    line[len++] = ';';
+                }
+            }
+            line[len++] = ' ';
+            len += profiler_format(&line[len], sample->weight, 10);
+            line[len++] = '\n';
+
+            output(arg, line, len);
+        }
+        dropped += shard->profiler.dropped;
+        XF_HEAP_UNLOCK(shard->lock);
+    }
+
+    if (dropped != 0) {
+        /* 采样记录已满时丢弃的采样不在上面的输出中，单独输出一行 */
+        static const char dropped_prefix[] = "[dropped] ";
+        for (len = 0; len < sizeof(dropped_prefix) - 1; len++) {
+            line[len] = dropped_prefix[len];
+        }
+        len += profiler_format(&line[len], dropped, 10);
+        line[len++] = '\n';
+        output(arg, line, len);
+    }
+
+    return dropped;
+}
+#endif
+
 /* ==================== [Static Functions] ================================== */
+
+/**
+ * @brief 申请内存，失败时调用回收回调后重试
+ *
+ * @param size 申请内存大小
+ * @param hint 生命周期提示
+ * @param zeroed 非0时返回清零的内存
+ * @param tag 计入的标签，未开启 XF_HEAP_TAG_ENABLE 时忽略
+ * @param caller 公开接口的返回地址，未开启 XF_HEAP_PROFILER_ENABLE 时忽略
+ * @return void* 申请内存的地址
+ */
+static void *heap_malloc(unsigned int size, xf_heap_lifetime_t hint, unsigned int zeroed,
+                         unsigned int tag, void *caller)
+{
+    void *res = (void*) 0;
+    unsigned char *puc;
+    unsigned int index;
+    unsigned int flags = (zeroed != 0) ? MALLOC_ZEROED : 0;
+    unsigned int cycles_start = 0;
+#if XF_HEAP_STATS_ENABLE
+    heap_shard_t *shard;
+
+    /* 借用其他分片和回收重试都计入同一次 xf_malloc 的耗时 */
+    cycles_start = XF_HEAP_CYCLES();
+#endif
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    /* 释放队列借用内存块自身存放链表指针 */
+    if ((size > 0) && (size < sizeof(void *))) {
+        size = sizeof(void *);
+    }
+#endif
+
+#if XF_HEAP_SHARD_NUM > 1
+    /* 未初始化时除分片0外的锁尚未设置 */
+    if (s_heap.init != XF_HEAP_MAGIC_NUM) {
+        return (void*) 0;
+    }
+#endif
+
+    res = shards_malloc(size, hint, tag, &flags, cycles_start);
+
+#if XF_HEAP_RECLAIM_ENABLE
+    /* 申请即将失败时依次调用回收回调，回调每回收到内存就重试一次，直到该回调无内存可回收 */
+    if ((size != 0) && (s_heap.init == XF_HEAP_MAGIC_NUM) && ((flags & MALLOC_OVER_BUDGET) == 0)) {
+        for (index = 0; (index < XF_HEAP_RECLAIM_NUM) && (res == (void*) 0); index++) {
+            while ((res == (void*) 0) && ((flags & MALLOC_OVER_BUDGET) == 0)
+                    && (reclaim_call(index, size) != 0)) {
+                res = shards_malloc(size, hint, tag, &flags, cycles_start);
+            }
+        }
+    }
+#endif
+
+#if XF_HEAP_STATS_ENABLE
+    /* 申请成功时已由分得内存的分片统计，失败时计入当前分片 */
+    if (res == (void*) 0) {
+        shard = &s_heap.shards[SHARD_CURRENT()];
+        XF_HEAP_LOCK(shard->lock);
+        {
+            stats_record_malloc(shard, size, XF_HEAP_CYCLES() - cycles_start);
+        }
+        XF_HEAP_UNLOCK(shard->lock);
+    }
+#endif
+
+#if XF_HEAP_PROFILER_ENABLE
+    if ((flags & MALLOC_SAMPLE) != 0) {
+        profiler_sample(SHARD_OF(res), res, size, caller);
+    }
+#else
+    (void) caller;
+#endif
+
+    /* 内存管理算法不支持 calloc 时在锁外清零 */
+    if (((flags & MALLOC_ZEROED) != 0) && (res != (void*) 0)) {
+        puc = (unsigned char *) res;
+        for (index = 0; index < size; index++) {
+            puc[index] = 0;
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @brief 从当前分片申请内存，当前分片不足时依次向其他分片借用
+ *
+ * @param size 申请内存大小
+ * @param hint 生命周期提示
+ * @param tag 计入的标签
+ * @param flags 申请标志，见 MALLOC_ZEROED、MALLOC_OVER_BUDGET、MALLOC_SAMPLE
+ * @param cycles_start xf_malloc 开始时的周期计数
+ * @return void* 申请内存的地址
+ */
+static void *shards_malloc(unsigned int size, xf_heap_lifetime_t hint, unsigned int tag,
+                           unsigned int *flags, unsigned int cycles_start)
+{
+    void *res = (void*) 0;
+    unsigned int index, current = SHARD_CURRENT();
+
+    for (index = 0; (index < XF_HEAP_SHARD_NUM) && (res == (void*) 0)
+            && ((*flags & MALLOC_OVER_BUDGET) == 0); index++) {
+        res = shard_malloc((current + index) % XF_HEAP_SHARD_NUM, size, hint, tag, flags, cycles_start);
+    }
+
+    return res;
+}
+
+/**
+ * @brief 加锁从指定分片申请内存并更新剩余内存统计
+ *
+ * @param index 分片编号
+ * @param size 申请内存大小
+ * @param hint 生命周期提示
+ * @param tag 计入的标签
+ * @param flags 申请标志，见 MALLOC_ZEROED、MALLOC_OVER_BUDGET，需要采样时置位 MALLOC_SAMPLE
+ * @param cycles_start xf_malloc 开始时的周期计数，申请成功时统计整次申请的耗时
+ * @return void* 申请内存的地址
+ */
+static void *shard_malloc(unsigned int index, unsigned int size, xf_heap_lifetime_t hint,
+                          unsigned int tag, unsigned int *flags, unsigned int cycles_start)
+{
+    heap_shard_t *shard = &s_heap.shards[index];
+    void *res = (void*) 0;
+#if XF_HEAP_STATS_ENABLE
+    unsigned int cycles_lock = XF_HEAP_CYCLES(), cycles_locked, cycles_done;
+#endif
+#if XF_HEAP_RECLAIM_ENABLE
+    int pressure = -1;
+    unsigned int free_bytes = 0;
+#endif
+
+    (void) index;
+    (void) cycles_start;
+
+    XF_HEAP_LOCK(shard->lock);
+    {
+#if XF_HEAP_STATS_ENABLE
+        cycles_locked = XF_HEAP_CYCLES();
+#endif
+        if (s_heap.init == XF_HEAP_MAGIC_NUM) {
+#if XF_HEAP_REMOTE_FREE_ENABLE
+            remote_free_drain(index);
+#endif
+            res = shard_take(index, size, hint, tag, flags);
+            if (res != (void*) 0) {
+                free_bytes_take(s_heap.func.get_block_size(res));
+#if XF_HEAP_PROFILER_ENABLE
+                /* 未采样时只有一次计数递减 */
+                shard->profiler.bytes_until_sample -= size;
+                if (shard->profiler.bytes_until_sample < 0) {
+                    shard->profiler.bytes_until_sample = profiler_next_interval(&shard->profiler);
+                    *flags |= MALLOC_SAMPLE;
+                }
+#endif
+            }
+#if XF_HEAP_STATS_ENABLE
+            if (s_heap.func.get_search_count != (void*) 0) {
+                stats_record(&shard->stats.search_nodes, SHARD_SEARCH_COUNT(index));
+            }
+#endif
+#if XF_HEAP_RECLAIM_ENABLE
+            pressure = watermark_update(&free_bytes);
+#endif
+        }
+#if XF_HEAP_STATS_ENABLE
+        /* 等锁和持锁时间按每次尝试统计 */
+        cycles_done = stats_record_lock(shard, cycles_lock, cycles_locked);
+        if (res != (void*) 0) {
+            stats_record_malloc(shard, size, cycles_done - cycles_start);
+        }
+#endif
+    }
+    XF_HEAP_UNLOCK(shard->lock);
+
+#if XF_HEAP_RECLAIM_ENABLE
+    watermark_notify(pressure, free_bytes);
+#endif
+
+    return res;
+}
+
+/**
+ * @brief 从指定分片取出内存块并计入标签，需在持有该分片锁时调用
+ *
+ * @param index 分片编号
+ * @param size 申请内存大小
+ * @param hint 生命周期提示
+ * @param tag 计入的标签
+ * @param flags 申请标志，已由内存管理算法清零时清除 MALLOC_ZEROED，超出标签上限时置位 MALLOC_OVER_BUDGET
+ * @return void* 申请内存的地址
+ */
+static void *shard_take(unsigned int index, unsigned int size, xf_heap_lifetime_t hint,
+                        unsigned int tag, unsigned int *flags)
+{
+    void *res;
+    unsigned int cleared = 0;
+
+    (void) index;
+    (void) tag;
+
+#if XF_HEAP_TAG_ENABLE
+    /* 申请大小已超出上限时不访问空闲链表 */
+    if (tag_over_budget(tag, size)) {
+        *flags |= MALLOC_OVER_BUDGET;
+        return (void*) 0;
+    }
+#endif
+
+    if (((*flags & MALLOC_ZEROED) != 0) && (s_heap.func.calloc != (void*) 0)) {
+        res = SHARD_CALLOC(index, size);
+        cleared = 1;
+    } else if ((hint != XF_HEAP_LIFETIME_SHORT) && (s_heap.func.malloc_hint != (void*) 0)) {
+        res = SHARD_MALLOC_HINT(index, size, hint);
+    } else {
+        res = SHARD_MALLOC(index, size);
+    }
+    if (res == (void*) 0) {
+        return (void*) 0;
+    }
+
+#if XF_HEAP_TAG_ENABLE
+    /* 内存块头和对齐使实际占用大于申请大小，超出上限时归还内存块 */
+    if (tag_take(tag, s_heap.func.get_block_size(res)) != 0) {
+        SHARD_FREE(index, res);
+        *flags |= MALLOC_OVER_BUDGET;
+        return (void*) 0;
+    }
+    if (s_heap.func.set_tag != (void*) 0) {
+        s_heap.func.set_tag(res, tag);
+    }
+#endif
+
+    if (cleared != 0) {
+        *flags &= ~MALLOC_ZEROED;
+    }
+
+    return res;
+}
+
+/**
+ * @brief 从剩余内存中扣除并更新历史最小剩余内存
+ *      @note 分片堆各分片的锁互不相同，需要原子操作
+ *
+ * @param size 内存块大小
+ */
+static void free_bytes_take(unsigned int size)
+{
+#if XF_HEAP_SHARD_NUM > 1
+    unsigned int free_bytes = XF_HEAP_ATOMIC_SUB_FETCH(&s_heap.free_bytes, size);
+    unsigned int min_ever = XF_HEAP_ATOMIC_LOAD(&s_heap.min_ever_free_bytes_remaining);
+
+    while ((min_ever > free_bytes)
+            && !XF_HEAP_ATOMIC_CAS(&s_heap.min_ever_free_bytes_remaining, &min_ever, free_bytes)) {
+    }
+#else
+    s_heap.free_bytes -= size;
+    if (s_heap.min_ever_free_bytes_remaining > s_heap.free_bytes) {
+        s_heap.min_ever_free_bytes_remaining = s_heap.free_bytes;
+    }
+#endif
+}
+
+/**
+ * @brief 归还到剩余内存
+ *
+ * @param size 内存块大小
+ */
+static void free_bytes_give(unsigned int size)
+{
+#if XF_HEAP_SHARD_NUM > 1
+    XF_HEAP_ATOMIC_ADD_FETCH(&s_heap.free_bytes, size);
+#else
+    s_heap.free_bytes += size;
+#endif
+}
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+
+/**
+ * @brief 将内存块压入跨线程释放队列，不加锁，仅一次CAS
+ *
+ * @param shard 内存块所属分片
+ * @param pv 需要释放的指针地址
+ */
+static void remote_free_push(heap_shard_t *shard, void *pv)
+{
+    void **node = (void **) pv;
+    void *head = XF_HEAP_ATOMIC_LOAD_PTR(&shard->remote_free_list);
+
+    do {
+        *node = head;
+    } while (!XF_HEAP_ATOMIC_CAS_PTR(&shard->remote_free_list, &head, pv));
+}
+
+/**
+ * @brief 取走整条跨线程释放队列并批量归还，需在持有该分片锁时调用
+ *
+ * @param index 分片编号
+ */
+static void remote_free_drain(unsigned int index)
+{
+    heap_shard_t *shard = &s_heap.shards[index];
+    void **node;
+    void **next;
+
+    if (XF_HEAP_ATOMIC_LOAD_PTR(&shard->remote_free_list) == (void*) 0) {
+        return;
+    }
+
+    node = (void **) XF_HEAP_ATOMIC_XCHG_PTR(&shard->remote_free_list, (void*) 0);
+    while (node != (void*) 0) {
+        next = (void **) *node;
+        free_bytes_give(s_heap.func.get_block_size(node));
+#if XF_HEAP_TAG_ENABLE
+        tag_give(TAG_OF(node), s_heap.func.get_block_size(node));
+#endif
+#if XF_HEAP_PROFILER_ENABLE
+        profiler_untrack(&shard->profiler, node);
+#endif
+        SHARD_FREE(index, node);
+        node = next;
+    }
+}
+
+#endif
+
+#if XF_HEAP_TAG_ENABLE
+
+/**
+ * @brief 判断申请是否会超出标签的上限
+ *
+ * @param tag 标签
+ * @param size 申请内存大小
+ * @return int 超出上限返回非0
+ */
+static int tag_over_budget(unsigned int tag, unsigned int size)
+{
+    tag_t *entry = &s_heap.tags[tag];
+#if XF_HEAP_SHARD_NUM > 1
+    unsigned int budget = XF_HEAP_ATOMIC_LOAD(&entry->budget);
+    unsigned int live = XF_HEAP_ATOMIC_LOAD(&entry->live_bytes);
+#else
+    unsigned int budget = entry->budget;
+    unsigned int live = entry->live_bytes;
+#endif
+
+    return TAG_OVER_BUDGET(live, size, budget);
+}
+
+/**
+ * @brief 将内存块计入标签，并更新峰值
+ *      @note 分片堆各分片的锁互不相同，上限检查和计入需在同一次原子比较交换中完成
+ *
+ * @param tag 标签
+ * @param size 内存块大小
+ * @return int 成功返回0，超出上限返回-1且不计入
+ */
+static int tag_take(unsigned int tag, unsigned int size)
+{
+    tag_t *entry = &s_heap.tags[tag];
+#if XF_HEAP_SHARD_NUM > 1
+    unsigned int budget = XF_HEAP_ATOMIC_LOAD(&entry->budget);
+    unsigned int live = XF_HEAP_ATOMIC_LOAD(&entry->live_bytes);
+    unsigned int peak;
+
+    do {
+        if (TAG_OVER_BUDGET(live, size, budget)) {
+            return -1;
+        }
+    } while (!XF_HEAP_ATOMIC_CAS(&entry->live_bytes, &live, live + size));
+    live += size;
+    XF_HEAP_ATOMIC_ADD_FETCH(&entry->count, 1);
+
+    peak = XF_HEAP_ATOMIC_LOAD(&entry->peak_bytes);
+    while ((peak < live) && !XF_HEAP_ATOMIC_CAS(&entry->peak_bytes, &peak, live)) {
+    }
+#else
+    if (TAG_OVER_BUDGET(entry->live_bytes, size, entry->budget)) {
+        return -1;
+    }
+    entry->live_bytes += size;
+    entry->count++;
+    if (entry->peak_bytes < entry->live_bytes) {
+        entry->peak_bytes = entry->live_bytes;
+    }
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief 从标签中扣除释放的内存块
+ *
+ * @param tag 标签
+ * @param size 内存块大小
+ */
+static void tag_give(unsigned int tag, unsigned int size)
+{
+    tag_t *entry = &s_heap.tags[tag % XF_HEAP_TAG_NUM];
+
+#if XF_HEAP_SHARD_NUM > 1
+    XF_HEAP_ATOMIC_SUB_FETCH(&entry->live_bytes, size);
+    XF_HEAP_ATOMIC_SUB_FETCH(&entry->count, 1);
+#else
+    entry->live_bytes -= size;
+    entry->count--;
+#endif
+}
+
+#endif
+
+#if XF_HEAP_RECLAIM_ENABLE
+
+/**
+ * @brief 在锁外调用一个回收回调
+ *
+ * @param index 回收回调的下标
+ * @param size 即将失败的申请大小
+ * @return unsigned int 回调释放的字节数，空位返回0
+ */
+static unsigned int reclaim_call(unsigned int index, unsigned int size)
+{
+    reclaim_t reclaim;
+
+    XF_HEAP_LOCK(s_heap.shards[0].lock);
+    {
+        reclaim = s_heap.reclaims[index];
+    }
+    XF_HEAP_UNLOCK(s_heap.shards[0].lock);
+
+    if (reclaim.cb == (void*) 0) {
+        return 0;
+    }
+
+    return reclaim.cb(reclaim.ctx, size);
+}
+
+/**
+ * @brief 根据剩余内存更新内存压力状态，需在持锁时调用
+ *      @note 分片堆各分片的锁互不相同，状态切换使用原子比较交换，保证只通知一次
+ *
+ * @param free_bytes 输出状态变化时的剩余内存
+ * @return int 新的内存压力状态，未变化返回-1
+ */
+static int watermark_update(unsigned int *free_bytes)
+{
+    unsigned int pressure, next;
+
+#if XF_HEAP_SHARD_NUM > 1
+    *free_bytes = XF_HEAP_ATOMIC_LOAD(&s_heap.free_bytes);
+    pressure = XF_HEAP_ATOMIC_LOAD(&s_heap.pressure);
+#else
+    *free_bytes = s_heap.free_bytes;
+    pressure = s_heap.pressure;
+#endif
+
+    if ((pressure == XF_HEAP_PRESSURE_NORMAL) && (*free_bytes < s_heap.low_watermark)) {
+        next = XF_HEAP_PRESSURE_LOW;
+    } else if ((pressure == XF_HEAP_PRESSURE_LOW) && (*free_bytes >= s_heap.high_watermark)) {
+        next = XF_HEAP_PRESSURE_NORMAL;
+    } else {
+        return -1;
+    }
+
+#if XF_HEAP_SHARD_NUM > 1
+    if (!XF_HEAP_ATOMIC_CAS(&s_heap.pressure, &pressure, next)) {
+        return -1;
+    }
+#else
+    s_heap.pressure = next;
+#endif
+
+    return (int) next;
+}
+
+/**
+ * @brief 在锁外通知水位回调
+ *
+ * @param pressure watermark_update 的返回值
+ * @param free_bytes 状态变化时的剩余内存
+ */
+static void watermark_notify(int pressure, unsigned int free_bytes)
+{
+    xf_heap_watermark_cb_t cb = s_heap.watermark_cb;
+
+    if ((pressure >= 0) && (cb != (void*) 0)) {
+        cb(s_heap.watermark_ctx, (xf_heap_pressure_t) pressure, free_bytes);
+    }
+}
+
+#endif
+
+#if XF_HEAP_STATS_ENABLE
+
+/**
+ * @brief 将一个值计入直方图
+ *
+ * @param histogram 直方图
+ * @param value 统计的值
+ */
+static void stats_record(xf_heap_histogram_t *histogram, unsigned int value)
+{
+    unsigned int bucket = 0;
+    unsigned int rest = value;
+
+    while ((rest != 0) && (bucket < (XF_HEAP_STATS_BUCKETS - 1))) {
+        rest >>= 1;
+        bucket++;
+    }
+
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->total += value;
+    if (histogram->max < value) {
+        histogram->max = value;
+    }
+}
+
+/**
+ * @brief 在释放锁之前统计等锁时间和持锁时间
+ *
+ * @param shard 持锁的分片
+ * @param cycles_start 开始等锁时的周期计数
+ * @param cycles_locked 获得锁时的周期计数
+ * @return unsigned int 统计时的周期计数
+ */
+static unsigned int stats_record_lock(heap_shard_t *shard, unsigned int cycles_start, unsigned int cycles_locked)
+{
+    unsigned int cycles_done = XF_HEAP_CYCLES();
+
+    stats_record(&shard->stats.lock_wait_cycles, cycles_locked - cycles_start);
+    stats_record(&shard->stats.lock_hold_cycles, cycles_done - cycles_locked);
+
+    return cycles_done;
+}
+
+/**
+ * @brief 在释放锁之前统计一次操作的耗时、等锁时间和持锁时间
+ *
+ * @param shard 持锁的分片
+ * @param histogram 操作耗时直方图
+ * @param cycles_start 开始等锁时的周期计数
+ * @param cycles_locked 获得锁时的周期计数
+ */
+static void stats_record_op(heap_shard_t *shard, xf_heap_histogram_t *histogram,
+                            unsigned int cycles_start, unsigned int cycles_locked)
+{
+    stats_record(histogram, stats_record_lock(shard, cycles_start, cycles_locked) - cycles_start);
+}
+
+/**
+ * @brief 统计一次 xf_malloc 的耗时，需在持有该分片锁时调用
+ *
+ * @param shard 持锁的分片
+ * @param size 申请内存大小
+ * @param cycles 整次申请的耗时
+ */
+static void stats_record_malloc(heap_shard_t *shard, unsigned int size, unsigned int cycles)
+{
+    stats_record(&shard->stats.malloc_cycles, cycles);
+    stats_record(&shard->stats.malloc_size_cycles[stats_size_class(size)], cycles);
+}
+
+/**
+ * @brief 将另一个直方图累加到直方图上
+ *
+ * @param histogram 直方图
+ * @param other 被累加的直方图
+ */
+static void stats_merge(xf_heap_histogram_t *histogram, const xf_heap_histogram_t *other)
+{
+    unsigned int bucket;
+
+    for (bucket = 0; bucket < XF_HEAP_STATS_BUCKETS; bucket++) {
+        histogram->buckets[bucket] += other->buckets[bucket];
+    }
+    histogram->count += other->count;
+    histogram->total += other->total;
+    if (histogram->max < other->max) {
+        histogram->max = other->max;
+    }
+}
+
+/**
+ * @brief 申请大小对应的分级
+ *
+ * @param size 申请内存大小
+ * @return unsigned int 分级，第 n 级为 [2^(n+3), 2^(n+4)) 字节
+ */
+static unsigned int stats_size_class(unsigned int size)
+{
+    unsigned int size_class = 0;
+
+    size >>= 4;
+    while ((size != 0) && (size_class < (XF_HEAP_STATS_SIZE_CLASSES - 1))) {
+        size >>= 1;
+        size_class++;
+    }
+
+    return size_class;
+}
+
+#endif
+
+#if XF_HEAP_PROFILER_ENABLE
+
+/**
+ * @brief 清空采样记录并重新生成采样间隔
+ *
+ * @param profiler 采样记录
+ * @param seed 随机数种子，各分片不同
+ */
+static void profiler_reset(profiler_t *profiler, unsigned int seed)
+{
+    unsigned int index;
+
+    for (index = 0; index < XF_HEAP_PROFILER_MAX_SAMPLES; index++) {
+        profiler->samples[index].ptr = (void*) 0;
+    }
+    profiler->live = 0;
+    profiler->dropped = 0;
+    profiler->rand = XF_HEAP_MAGIC_NUM + seed;
+    profiler->bytes_until_sample = profiler_next_interval(profiler);
+}
+
+/**
+ * @brief 计算 e^(-x)，x >= 0
+ *      @note 先减半到 0.5 以内用泰勒展开，再平方还原，避免依赖libm
+ */
+static float profiler_exp_neg(float x)
+{
+    unsigned int halving = 0;
+    float res;
+
+    while (x > 0.5f) {
+        x *= 0.5f;
+        halving++;
+    }
+
+    res = 1.0f - x * (1.0f - x * (0.5f - x * (1.0f / 6.0f - x * (1.0f / 24.0f))));
+    while (halving-- > 0) {
+        res *= res;
+    }
+
+    return res;
+}
+
+/**
+ * @brief 记录一次采样，在释放分片锁之后调用
+ *      @note 调用栈在锁外获取，去掉 caller 之前内存管理内部的栈帧后，frames[0] 为调用 xf_malloc 的位置
+ *
+ * @param index 内存所属分片
+ * @param pv 被采样的内存
+ * @param size 申请内存的大小
+ * @param caller 公开接口的返回地址，(void*) 0 时保留完整调用栈
+ */
+static void profiler_sample(unsigned int index, void *pv, unsigned int size, void *caller)
+{
+    heap_shard_t *shard = &s_heap.shards[index];
+    profiler_sample_t *sample = (void*) 0;
+    void *frames[XF_HEAP_PROFILER_MAX_DEPTH + PROFILER_INTERNAL_DEPTH];
+    int depth, skip = 0;
+    unsigned int slot;
+    float probability, weight;
+
+    depth = XF_HEAP_BACKTRACE(frames, XF_HEAP_PROFILER_MAX_DEPTH + PROFILER_INTERNAL_DEPTH);
+    if (depth < 0) {
+        depth = 0;
+    }
+    if (caller != (void*) 0) {
+        while ((skip < depth) && (skip < PROFILER_INTERNAL_DEPTH) && (frames[skip] != caller)) {
+            skip++;
+        }
+        /* 未找到调用点时保留完整调用栈 */
+        if ((skip == depth) || (frames[skip] != caller)) {
+            skip = 0;
+        }
+    }
+    depth -= skip;
+    if (depth > XF_HEAP_PROFILER_MAX_DEPTH) {
+        depth = XF_HEAP_PROFILER_MAX_DEPTH;
+    }
+
+    /* 大小为 size 的申请被采样的概率为 1 - e^(-size/rate)，以其倒数加权得到无偏估计 */
+    probability = 1.0f - profiler_exp_neg((float) size / (float) XF_HEAP_PROFILER_SAMPLE_RATE);
+    weight = (float) size / probability;
+
+    XF_HEAP_LOCK(shard->lock);
+    {
+        for (slot = 0; slot < XF_HEAP_PROFILER_MAX_SAMPLES; slot++) {
+            if (shard->profiler.samples[slot].ptr == (void*) 0) {
+                sample = &shard->profiler.samples[slot];
+                break;
+            }
+        }
+        if (sample != (void*) 0) {
+            sample->ptr = pv;
+            sample->weight = (weight < 4294967040.0f) ? (unsigned int) weight : 0xFFFFFFFFu;
+            sample->depth = depth;
+            for (slot = 0; slot < (unsigned int) depth; slot++) {
+                sample->frames[slot] = frames[skip + slot];
+            }
+            shard->profiler.live++;
+            if (SAMPLED_MARK_SUPPORTED()) {
+                s_heap.func.set_sampled(pv);
+            }
+        } else {
+            shard->profiler.dropped++;
+        }
+    }
+    XF_HEAP_UNLOCK(shard->lock);
+}
+
+/**
+ * @brief 内存释放时移除其采样记录
+ *
+ * @param profiler 采样记录
+ * @param pv 被释放的内存
+ */
+static void profiler_untrack(profiler_t *profiler, void *pv)
+{
+    unsigned int index;
+
+    if (profiler->live == 0) {
+        return;
+    }
+    /* 未被采样的内存块不查找采样记录 */
+    if (SAMPLED_MARK_SUPPORTED() && (s_heap.func.is_sampled(pv) == 0)) {
+        return;
+    }
+
+    for (index = 0; index < XF_HEAP_PROFILER_MAX_SAMPLES; index++) {
+        if (profiler->samples[index].ptr == pv) {
+            profiler->samples[index].ptr = (void*) 0;
+            profiler->live--;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 生成服从几何分布的下一次采样间隔，均值为 XF_HEAP_PROFILER_SAMPLE_RATE
+ *      @note 间隔为 -ln(u) * rate，u 为 (0, 1] 上的均匀分布，对数使用二次多项式近似
+ *
+ * @param profiler 采样记录
+ */
+static long profiler_next_interval(profiler_t *profiler)
+{
+    unsigned int rand = profiler->rand;
+    unsigned int q, msb = 0;
+    float fraction, log2_q;
+
+    rand ^= rand << 13;
+    rand ^= rand >> 17;
+    rand ^= rand << 5;
+    profiler->rand = rand;
+
+    /* 取高26位，q 取值 1 ~ 2^26 */
+    q = ((rand >> 6) & 0x3FFFFFF) + 1;
+    while ((q >> (msb + 1)) != 0) {
+        msb++;
+    }
+    fraction = (float)(q - (1u << msb)) / (float)(1u << msb);
+    log2_q = (float) msb + fraction * (1.3465f - 0.3465f * fraction);
+
+    return (long)((26.0f - log2_q) * 0.6931472f * (float) XF_HEAP_PROFILER_SAMPLE_RATE) + 1;
+}
+
+/**
+ * @brief 将整数格式化为字符串，十六进制带 0x 前缀
+ *
+ * @param buf 输出缓冲区
+ * @param value 整数
+ * @param base 进制，10 或 16
+ * @return unsigned int 输出的字符数
+ */
+static unsigned int profiler_format(char *buf, xf_heap_intptr_t value, unsigned int base)
+{
+    static const char digits[] = "0123456789abcdef";
+    char tmp[sizeof(xf_heap_intptr_t) * 3];
+    unsigned long long number = (unsigned long long) value;
+    unsigned int len = 0, count = 0;
+
+    /* 按无符号数输出，避免负数符号扩展 */
+    number &= ~0ULL >> ((sizeof(number) - sizeof(xf_heap_intptr_t)) * 8);
+
+    if (base == 16) {
+        buf[len++] = '0';
+        buf[len++] = 'x';
+    }
+
+    do {
+        tmp[count++] = digits[number % base];
+        number /= base;
+    } while (number != 0);
+
+    while (count > 0) {
+        buf[len++] = tmp[--count];
+    }
+
+    return len;
+}
+
+#endif
@@ -27,9 +27,19 @@ extern "C" {
 
 /* ==================== [Typedefs] =========================================== */
 
+/**
+ * @brief 内存生命周期提示
+ *
+ */
+typedef enum _xf_heap_lifetime_t {
+    XF_HEAP_LIFETIME_SHORT = 0,     /*!< 短生命周期，从内存区域低地址端切割 */
+    XF_HEAP_LIFETIME_LONG,          /*!< 长生命周期，从内存区域高地址端切割 */
+} xf_heap_lifetime_t;
+
 typedef struct _xf_heap_region_t {
     unsigned char *stat_address;  /*!< 内存块起始地址 */
     unsigned int size_in_bytes;   /*!< 内存块大小 */
+    unsigned int zeroed;          /*!< 非0表示内存块已全部清零，xf_calloc 可以跳过清零 */
 } xf_heap_region_t;
 
 typedef struct _xf_alloc_func_t {
@@ -37,8 +47,95 @@ typedef struct _xf_alloc_func_t {
     void (*free)(void *pv);
     unsigned int (*init)(const xf_heap_region_t *const regions);
     unsigned int (*get_block_size)(void *pv); /*!< 获取内存块的大小 */
+    void *(*malloc_hint)(unsigned int size, xf_heap_lifetime_t hint); /*!< 带生命周期提示的申请，可为空 */
+    unsigned int (*get_search_count)(void); /*!< 获取上一次申请访问的空闲链表节点数，可为空 */
+    void *(*calloc)(unsigned int size);     /*!< 申请清零的内存，可为空 */
+    void (*set_tag)(void *pv, unsigned int tag); /*!< 记录内存块的标签，可为空 */
+    unsigned int (*get_tag)(void *pv);      /*!< 获取内存块的标签，可为空，与 set_tag 同时为空时所有内存计入标签0 */
+    void (*set_sampled)(void *pv);          /*!< 标记内存块被采样，可为空 */
+    unsigned int (*is_sampled)(void *pv);   /*!< 内存块是否被标记为采样，可为空，为空时每次释放都查找采样记录 */
 } xf_alloc_func_t;
 
+#if XF_HEAP_STATS_ENABLE
+/**
+ * @brief 按2的幂分桶的直方图
+ *
+ */
+typedef struct _xf_heap_histogram_t {
+    unsigned int count;                         /*!< 统计次数 */
+    unsigned int max;                           /*!< 最大值 */
+    unsigned long long total;                   /*!< 总和 */
+    unsigned int buckets[XF_HEAP_STATS_BUCKETS]; /*!< 第0个桶统计值为0，第n个桶统计 [2^(n-1), 2^n) */
+} xf_heap_histogram_t;
+
+/**
+ * @brief 耗时统计快照，耗时单位为 XF_HEAP_CYCLES 的周期
+ *
+ */
+typedef struct _xf_heap_stats_t {
+    xf_heap_histogram_t malloc_cycles;          /*!< xf_malloc 耗时，包含等锁、借用其他分片和回收重试的时间 */
+    xf_heap_histogram_t free_cycles;            /*!< xf_free 耗时，包含等锁时间 */
+    xf_heap_histogram_t malloc_size_cycles[XF_HEAP_STATS_SIZE_CLASSES]; /*!< 各申请大小的 xf_malloc 耗时 */
+    xf_heap_histogram_t lock_wait_cycles;       /*!< XF_HEAP_LOCK 等待时间，每次加锁统计一次 */
+    xf_heap_histogram_t lock_hold_cycles;       /*!< XF_HEAP_LOCK 持有时间，每次加锁统计一次 */
+    xf_heap_histogram_t search_nodes;           /*!< 每次查找空闲链表访问的节点数 */
+} xf_heap_stats_t;
+#endif
+
+#if XF_HEAP_PROFILER_ENABLE
+/**
+ * @brief 采样数据输出函数
+ *
+ * @param arg 用户参数
+ * @param str 输出的字符串，不以'\0'结尾
+ * @param len 字符串长度
+ */
+typedef void (*xf_heap_profiler_output_t)(void *arg, const char *str, unsigned int len);
+#endif
+
+#if XF_HEAP_RECLAIM_ENABLE
+/**
+ * @brief 回收回调，在申请即将失败时调用，此时未持有 XF_HEAP_LOCK，可以调用 xf_free
+ *      @note 回调内不能调用 xf_malloc 等申请函数，否则申请失败时会再次进入回调
+ *
+ * @param ctx 注册时的用户参数
+ * @param size 即将失败的申请大小
+ * @return unsigned int 释放的字节数，返回0表示没有可回收的内存
+ */
+typedef unsigned int (*xf_heap_reclaim_cb_t)(void *ctx, unsigned int size);
+
+/**
+ * @brief 内存压力状态
+ *
+ */
+typedef enum _xf_heap_pressure_t {
+    XF_HEAP_PRESSURE_NORMAL = 0,    /*!< 剩余内存回升到高水位 */
+    XF_HEAP_PRESSURE_LOW,           /*!< 剩余内存低于低水位 */
+} xf_heap_pressure_t;
+
+/**
+ * @brief 水位回调，内存压力状态变化时调用，此时未持有 XF_HEAP_LOCK
+ *
+ * @param ctx 设置时的用户参数
+ * @param pressure 新的内存压力状态
+ * @param free_bytes 状态变化时的剩余内存
+ */
+typedef void (*xf_heap_watermark_cb_t)(void *ctx, xf_heap_pressure_t pressure, unsigned int free_bytes);
+#endif
+
+#if XF_HEAP_TAG_ENABLE
+/**
+ * @brief 标签统计快照，字节数按内存块大小计算，包含内存块头和对齐
+ *
+ */
+typedef struct _xf_heap_tag_stats_t {
+    unsigned int live_bytes;            /*!< 在用字节数 */
+    unsigned int peak_bytes;            /*!< 在用字节数的峰值 */
+    unsigned int count;                 /*!< 在用内存块数 */
+    unsigned int budget;                /*!< 在用字节数上限，0表示不限 */
+} xf_heap_tag_stats_t;
+#endif
+
 /* ==================== [Global Prototypes] ================================= */
 
 /**
@@ -49,21 +146,56 @@ typedef struct _xf_alloc_func_t {
  */
 void *xf_malloc(unsigned int size);
 
+/**
+ * @brief 申请清零的内存
+ *
+ * @param num 元素个数
+ * @param size 每个元素的大小
+ * @return void* 申请内存的地址，num * size 溢出时返回 (void*) 0
+ *
+ * @note 来自已声明清零的内存区域、且申请后未被使用过的内存不会重复清零
+ */
+void *xf_calloc(unsigned int num, unsigned int size);
+
+/**
+ * @brief 带生命周期提示的内存申请
+ *
+ * @param size 申请内存大小
+ * @param hint 生命周期提示，长生命周期的内存集中在高地址端，
+ *             避免夹在频繁申请释放的短生命周期内存之间造成碎片
+ * @return void* 申请内存的地址
+ *
+ * @note 重定向的内存管理算法未提供 malloc_hint 时等同于 xf_malloc
+ */
+void *xf_malloc_hint(unsigned int size, xf_heap_lifetime_t hint);
+
 /**
  * @brief 释放内存
  *
  * @param pv 释放内存的大小
  *
  * @note 释放内存时记得将指针指向NULL，以防出现访问未申请的内存
+ * @note 开启 XF_HEAP_REMOTE_FREE_ENABLE 后，非所属线程的释放只压入无锁队列，
+ *       内存在下一次 xf_malloc 或 xf_heap_get_free_size 时才真正归还
  */
 void xf_free(void *pv);
 
+#if XF_HEAP_REMOTE_FREE_ENABLE
+/**
+ * @brief 将当前线程设置为堆的所属线程
+ *
+ * @note xf_heap_init 时默认以调用线程为所属线程
+ */
+void xf_heap_set_owner(void);
+#endif
+
 /**
  * @brief 相关申请的函数重定向
  *
  * @param func 重定向的函数
  *
  * @note 该函数只能在未初始化之前调用
+ * @note malloc、free、init 必须提供，其余可选成员不提供时需置为 (void*) 0
 * @return int 0 设置成功， -1 设置失败
  */
 xf_heap_err_t xf_heap_redirect(xf_alloc_func_t func);
@@ -74,6 +206,8 @@ xf_heap_err_t xf_heap_redirect(xf_alloc_func_t func);
  * @param regions 注册不同内存区域，数组最后一个必须是{}
  *
  * @note 该函数只能在xf_malloc之前调用
+ * @note 内存块大小的次高位用作清零标志，单个内存块小于 2^30 字节：更大的内存区域注册时
+ *       切割为多个相连的内存块，释放时也不会合并超过该大小，因此单次申请不超过约1GB
  * 
  * @return int 0 设置成功， -1 设置失败 
  */
@@ -100,6 +234,124 @@ unsigned int xf_heap_get_free_size(void);
  */
 unsigned int xf_heap_get_min_ever_free_size(void);
 
+#if XF_HEAP_RECLAIM_ENABLE
+/**
+ * @brief 注册回收回调，申请即将失败时按注册顺序调用，回调每释放一次内存就重试一次申请，
+ *        直到申请成功或该回调返回0
+ *
+ * @param cb 回收回调
+ * @param ctx 用户参数
+ * @return xf_heap_err_t
+ *      - XF_HEAP_OK            注册成功
+ *      - XF_HEAP_INVALID_ARG   回调为空
+ *      - XF_HEAP_FULL          已达到 XF_HEAP_RECLAIM_NUM 个
+ */
+xf_heap_err_t xf_heap_register_reclaim(xf_heap_reclaim_cb_t cb, void *ctx);
+
+/**
+ * @brief 注销回收回调
+ *
+ * @param cb 回收回调
+ * @param ctx 注册时的用户参数
+ * @return xf_heap_err_t
+ *      - XF_HEAP_OK            注销成功
+ *      - XF_HEAP_INVALID_ARG   未注册过该回调
+ */
+xf_heap_err_t xf_heap_unregister_reclaim(xf_heap_reclaim_cb_t cb, void *ctx);
+
+/**
+ * @brief 设置剩余内存水位
+ *      @note 剩余内存低于 low 时通知 XF_HEAP_PRESSURE_LOW，之后回升到不低于 high 时
+ *      通知 XF_HEAP_PRESSURE_NORMAL，两者之间的波动不会重复通知
+ *
+ * @param low 低水位
+ * @param high 高水位，需不小于 low
+ * @param cb 水位回调，为空时关闭水位通知
+ * @param ctx 用户参数
+ * @return xf_heap_err_t
+ *      - XF_HEAP_OK            设置成功
+ *      - XF_HEAP_INVALID_ARG   high 小于 low
+ */
+xf_heap_err_t xf_heap_set_watermark(unsigned int low, unsigned int high,
+                                    xf_heap_watermark_cb_t cb, void *ctx);
+
+/**
+ * @brief 获取当前内存压力状态
+ *
+ * @return xf_heap_pressure_t 内存压力状态
+ */
+xf_heap_pressure_t xf_heap_get_pressure(void);
+#endif
+
+#if XF_HEAP_TAG_ENABLE
+/**
+ * @brief 带标签的内存申请，申请的内存计入该标签的统计
+ *
+ * @param size 申请内存大小
+ * @param tag 标签，小于 XF_HEAP_TAG_NUM
+ * @return void* 申请内存的地址，标签无效或超出该标签的上限时返回 (void*) 0
+ *
+ * @note 超出上限时直接失败，不访问空闲链表，也不调用回收回调
+ */
+void *xf_malloc_tagged(unsigned int size, unsigned int tag);
+
+/**
+ * @brief 设置标签的在用字节数上限
+ *
+ * @param tag 标签
+ * @param budget 上限，按内存块大小计算，0表示不限
+ * @return xf_heap_err_t
+ *      - XF_HEAP_OK            设置成功
+ *      - XF_HEAP_INVALID_ARG   标签无效
+ *
+ * @note 上限低于当前在用字节数时，已申请的内存不受影响，之后该标签的申请都会失败
+ */
+xf_heap_err_t xf_heap_set_tag_budget(unsigned int tag, unsigned int budget);
+
+/**
+ * @brief 获取标签统计快照
+ *
+ * @param tag 标签
+ * @param stats 快照输出
+ * @return xf_heap_err_t
+ *      - XF_HEAP_OK            获取成功
+ *      - XF_HEAP_INVALID_ARG   标签无效或 stats 为空
+ */
+xf_heap_err_t xf_heap_get_tag_stats(unsigned int tag, xf_heap_tag_stats_t *stats);
+#endif
+
+#if XF_HEAP_STATS_ENABLE
+/**
+ * @brief 获取耗时统计快照
+ *
+ * @param stats 快照输出
+ *
+ * @note 跨线程释放队列的无锁释放不计入统计
+ */
+void xf_heap_get_stats(xf_heap_stats_t *stats);
+
+/**
+ * @brief 清空耗时统计
+ *
+ */
+void xf_heap_reset_stats(void);
+#endif
+
+#if XF_HEAP_PROFILER_ENABLE
+/**
+ * @brief 以折叠栈格式导出仍未释放的采样
+ *
+ * @param output 输出函数，每行为 "frame;frame;... bytes\n"，调用栈由外到内，
+ *               bytes 为该采样所代表的估计字节数。采样记录已满时丢弃的采样数不为0时，
+ *               最后输出一行 "[dropped] count\n"
+ * @param arg 输出函数的用户参数
+ * @return unsigned int 采样记录已满而丢弃的采样数，导出结果少计了这部分内存
+ *
+ * @note 导出时持有 XF_HEAP_LOCK，输出函数中不可调用 xf_malloc/xf_free
+ */
+unsigned int xf_heap_profiler_dump(xf_heap_profiler_output_t output, void *arg);
+#endif
+
 /* ==================== [Macros] ============================================ */
 
 #ifdef __cplusplus
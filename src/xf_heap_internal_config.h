@@ -64,6 +64,18 @@ typedef XF_HEAP_ERR_TYPE xf_heap_err_t;
 #define XF_HEAP_UNINIT (2)
 #endif
 
+#ifndef XF_HEAP_NOT_SUPPORT
+#define XF_HEAP_NOT_SUPPORT (3)
+#endif
+
+#ifndef XF_HEAP_INVALID_ARG
+#define XF_HEAP_INVALID_ARG (4)
+#endif
+
+#ifndef XF_HEAP_FULL
+#define XF_HEAP_FULL (5)
+#endif
+
 /**
  * @brief heap的指针整数数类型
  * 
@@ -76,6 +88,143 @@ typedef XF_HEAP_ERR_TYPE xf_heap_err_t;
  
 typedef XF_HEAP_INTPTR_TYPE xf_heap_intptr_t;
 
+/**
+ * @brief 跨线程释放队列
+ *      @note 开启后，非所属线程调用 xf_free 不再争抢 XF_HEAP_LOCK，
+ *      而是压入无锁的释放队列，由下一次 xf_malloc 批量归还
+ */
+
+#ifndef XF_HEAP_REMOTE_FREE_ENABLE
+#define XF_HEAP_REMOTE_FREE_ENABLE 0
+#endif
+
+/* 获取当前线程标识，用于判断调用者是否为堆的所属线程 */
+#ifndef XF_HEAP_THREAD_ID
+#define XF_HEAP_THREAD_ID() ((xf_heap_intptr_t)0)
+#endif
+
+/**
+ * @brief 快速链表（延迟合并）
+ *      @note 开启后，释放的小内存块按实际大小暂存在快速链表中，同尺寸申请直接复用，
+ *      只有暂存块数超过阈值或空闲链表无法满足申请时才批量合并回空闲链表
+ */
+
+#ifndef XF_HEAP_QUICK_LIST_ENABLE
+#define XF_HEAP_QUICK_LIST_ENABLE 0
+#endif
+
+/* 快速链表个数，第 n 个链表存放用户区大小为 (n + 1) * XF_HEAP_BYTE_ALIGNMENT 的内存块 */
+#ifndef XF_HEAP_QUICK_LIST_NUM
+#define XF_HEAP_QUICK_LIST_NUM 16
+#endif
+
+/* 快速链表暂存块数上限，超过后全部合并回空闲链表 */
+#ifndef XF_HEAP_QUICK_LIST_THRESHOLD
+#define XF_HEAP_QUICK_LIST_THRESHOLD 32
+#endif
+
+/**
+ * @brief 采样内存分析
+ *      @note 开启后，xf_malloc 平均每申请 XF_HEAP_PROFILER_SAMPLE_RATE 字节采样一次
+ *      调用栈（采样间隔服从几何分布，统计结果无偏），被采样的内存在释放前一直被记录，
+ *      可通过 xf_heap_profiler_dump 以折叠栈格式导出
+ */
+
+#ifndef XF_HEAP_PROFILER_ENABLE
+#define XF_HEAP_PROFILER_ENABLE 0
+#endif
+
+/* 平均采样间隔（字节） */
+#ifndef XF_HEAP_PROFILER_SAMPLE_RATE
+#define XF_HEAP_PROFILER_SAMPLE_RATE 65536
+#endif
+
+/* 同时记录的采样数上限，超出的采样被丢弃 */
+#ifndef XF_HEAP_PROFILER_MAX_SAMPLES
+#define XF_HEAP_PROFILER_MAX_SAMPLES 64
+#endif
+
+/* 每个采样记录的调用栈最大深度 */
+#ifndef XF_HEAP_PROFILER_MAX_DEPTH
+#define XF_HEAP_PROFILER_MAX_DEPTH 8
+#endif
+
+/**
+ * @brief 耗时统计
+ *      @note 开启后，以 XF_HEAP_CYCLES 计时，按2的幂分桶统计 xf_malloc/xf_free 的耗时、
+ *      各申请大小的耗时、XF_HEAP_LOCK 的等待与持有时间，以及每次申请访问的空闲链表节点数
+ */
+
+#ifndef XF_HEAP_STATS_ENABLE
+#define XF_HEAP_STATS_ENABLE 0
+#endif
+
+/* 直方图桶数，最后一个桶统计所有更大的值 */
+#ifndef XF_HEAP_STATS_BUCKETS
+#define XF_HEAP_STATS_BUCKETS 16
+#endif
+
+/* 申请大小分级数，第 n 级为 [2^(n+3), 2^(n+4)) 字节，首尾两级包含更小和更大的申请 */
+#ifndef XF_HEAP_STATS_SIZE_CLASSES
+#define XF_HEAP_STATS_SIZE_CLASSES 8
+#endif
+
+/**
+ * @brief 分片堆
+ *      @note 分片数大于1时，注册的内存按地址均分给各个分片，每个分片拥有独立的空闲链表、
+ *      锁、跨线程释放队列和统计数据。申请时由 XF_HEAP_SHARD_ID 选择分片，
+ *      当前分片不足时依次向其他分片借用；释放时按地址归还到所属分片
+ */
+
+#ifndef XF_HEAP_SHARD_NUM
+#define XF_HEAP_SHARD_NUM 1
+#endif
+
+/**
+ * @brief 内存压力回调
+ *      @note 开启后，申请即将失败时在锁外依次调用注册的回收回调，回调释放内存后重试申请；
+ *      剩余内存低于低水位或回升到高水位时，在锁外通知水位回调
+ */
+
+#ifndef XF_HEAP_RECLAIM_ENABLE
+#define XF_HEAP_RECLAIM_ENABLE 0
+#endif
+
+/* 可注册的回收回调个数上限 */
+#ifndef XF_HEAP_RECLAIM_NUM
+#define XF_HEAP_RECLAIM_NUM 4
+#endif
+
+/**
+ * @brief 紧凑内存块头
+ *      @note 开启后，已占用的内存块只保留4字节的大小和标志，空闲链表的下一块改为
+ *      相对第一块注册内存的32位偏移，存放在空闲内存块的用户区开头。
+ *      64位平台下每个内存块节省的字节数取决于 XF_HEAP_BYTE_ALIGNMENT，
+ *      超出第一块注册内存之后4GB的内存区域不会被注册
+ */
+
+#ifndef XF_HEAP_COMPACT_HEADER
+#define XF_HEAP_COMPACT_HEADER 0
+#endif
+
+/**
+ * @brief 内存标签
+ *      @note 开启后，xf_malloc_tagged 把标签记录在已占用内存块大小的空闲高位中，
+ *      按标签统计在用字节数、峰值和内存块数，并可为每个标签设置上限，超出上限的申请
+ *      直接失败，不会调用回收回调。单个内存块的大小上限降为 2^(30 - XF_HEAP_TAG_BITS) 字节
+ */
+
+#ifndef XF_HEAP_TAG_ENABLE
+#define XF_HEAP_TAG_ENABLE 0
+#endif
+
+/* 标签占用的位数，标签编号范围为 [0, 2^XF_HEAP_TAG_BITS)，xf_malloc 等使用标签0 */
+#ifndef XF_HEAP_TAG_BITS
+#define XF_HEAP_TAG_BITS 3
+#endif
+
+#define XF_HEAP_TAG_NUM (1u << XF_HEAP_TAG_BITS)
+
 /* ==================== [Typedefs] ========================================== */
 
 /* ==================== [Global Prototypes] ================================= */
@@ -96,6 +245,87 @@ typedef XF_HEAP_INTPTR_TYPE xf_heap_intptr_t;
 #define XF_HEAP_ASSERT(x)
 #endif // XF_HEAP_ASSERT
 
+/**
+ * @brief 获取调用栈，FRAMES 为 void* 数组，DEPTH 为数组长度，返回实际深度
+ *      @note 默认不获取调用栈，采样全部归到同一个未知调用点。
+ *      glibc 下可对接 backtrace，RTOS 下可对接其栈回溯函数
+ */
+#ifndef XF_HEAP_BACKTRACE
+#define XF_HEAP_BACKTRACE(FRAMES, DEPTH) ((void)(FRAMES), (void)(DEPTH), 0)
+#endif // XF_HEAP_BACKTRACE
+
+/**
+ * @brief 获取当前函数的返回地址，采样时据此去掉调用栈中 xf_malloc 及其内部的栈帧
+ *      @note 返回 (void*) 0 时保留完整调用栈
+ */
+#ifndef XF_HEAP_RETURN_ADDRESS
+#if defined(__GNUC__)
+#define XF_HEAP_RETURN_ADDRESS() __builtin_return_address(0)
+#else
+#define XF_HEAP_RETURN_ADDRESS() ((void*) 0)
+#endif
+#endif // XF_HEAP_RETURN_ADDRESS
+
+/* 获取当前的周期计数，返回 unsigned int，允许溢出回绕。例如 Cortex-M 的 DWT->CYCCNT */
+#ifndef XF_HEAP_CYCLES
+#define XF_HEAP_CYCLES() ((unsigned int)0)
+#endif // XF_HEAP_CYCLES
+
+/* 获取当前应使用的分片编号，结果会对 XF_HEAP_SHARD_NUM 取模。例如 Linux 下的 sched_getcpu() */
+#ifndef XF_HEAP_SHARD_ID
+#define XF_HEAP_SHARD_ID() 0
+#endif // XF_HEAP_SHARD_ID
+
+/* 各分片锁的指针，默认所有分片共用 XF_HEAP_LOCK_PTR */
+#ifndef XF_HEAP_SHARD_LOCK_PTR
+#define XF_HEAP_SHARD_LOCK_PTR(SHARD) ((void)(SHARD), XF_HEAP_LOCK_PTR)
+#endif // XF_HEAP_SHARD_LOCK_PTR
+
+#if XF_HEAP_SHARD_NUM > 1
+
+/* 原子读取 unsigned int，默认使用GCC/Clang内建函数，其他编译器需自行对接 */
+#ifndef XF_HEAP_ATOMIC_LOAD
+#define XF_HEAP_ATOMIC_LOAD(PVAL) __atomic_load_n((PVAL), __ATOMIC_RELAXED)
+#endif // XF_HEAP_ATOMIC_LOAD
+
+/* 原子加，返回新值 */
+#ifndef XF_HEAP_ATOMIC_ADD_FETCH
+#define XF_HEAP_ATOMIC_ADD_FETCH(PVAL, VAL) __atomic_add_fetch((PVAL), (VAL), __ATOMIC_RELAXED)
+#endif // XF_HEAP_ATOMIC_ADD_FETCH
+
+/* 原子减，返回新值 */
+#ifndef XF_HEAP_ATOMIC_SUB_FETCH
+#define XF_HEAP_ATOMIC_SUB_FETCH(PVAL, VAL) __atomic_sub_fetch((PVAL), (VAL), __ATOMIC_RELAXED)
+#endif // XF_HEAP_ATOMIC_SUB_FETCH
+
+/* 原子比较交换 unsigned int，成功返回非0，失败时将当前值写回 PEXPECTED */
+#ifndef XF_HEAP_ATOMIC_CAS
+#define XF_HEAP_ATOMIC_CAS(PVAL, PEXPECTED, DESIRED) \
+    __atomic_compare_exchange_n((PVAL), (PEXPECTED), (DESIRED), 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif // XF_HEAP_ATOMIC_CAS
+
+#endif // XF_HEAP_SHARD_NUM > 1
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+
+/* 原子读取指针，默认使用GCC/Clang内建函数，其他编译器需自行对接 */
+#ifndef XF_HEAP_ATOMIC_LOAD_PTR
+#define XF_HEAP_ATOMIC_LOAD_PTR(PPTR) __atomic_load_n((PPTR), __ATOMIC_RELAXED)
+#endif // XF_HEAP_ATOMIC_LOAD_PTR
+
+/* 原子比较交换指针，成功返回非0，失败时将当前值写回 PEXPECTED */
+#ifndef XF_HEAP_ATOMIC_CAS_PTR
+#define XF_HEAP_ATOMIC_CAS_PTR(PPTR, PEXPECTED, DESIRED) \
+    __atomic_compare_exchange_n((PPTR), (PEXPECTED), (DESIRED), 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+#endif // XF_HEAP_ATOMIC_CAS_PTR
+
+/* 原子交换指针，返回旧值 */
+#ifndef XF_HEAP_ATOMIC_XCHG_PTR
+#define XF_HEAP_ATOMIC_XCHG_PTR(PPTR, VAL) __atomic_exchange_n((PPTR), (VAL), __ATOMIC_ACQUIRE)
+#endif // XF_HEAP_ATOMIC_XCHG_PTR
+
+#endif // XF_HEAP_REMOTE_FREE_ENABLE
+
 
 
 #ifdef __cplusplus
@@ -64,6 +64,19 @@ TEST(heap_group, heap_free)
     TEST_ASSERT_EQUAL(s_size, _size);
 }
 
+TEST(heap_group, heap_malloc_hint)
+{
+    void *p_short = xf_malloc_hint(sizeof(int), XF_HEAP_LIFETIME_SHORT);
+    void *p_long = xf_malloc_hint(sizeof(int), XF_HEAP_LIFETIME_LONG);
+    TEST_ASSERT_NOT_NULL(p_short);
+    TEST_ASSERT_NOT_NULL(p_long);
+    /* 长生命周期从当前分片的高地址端切割 */
+    TEST_ASSERT_GREATER_THAN((uintptr_t)(s_heap_arr + 6144 / XF_HEAP_SHARD_NUM / 2), (uintptr_t)p_long);
+    TEST_ASSERT_LESS_THAN((uintptr_t)(s_heap_arr + 6144 / XF_HEAP_SHARD_NUM / 2), (uintptr_t)p_short);
+    xf_free(p_long);
+    xf_free(p_short);
+    TEST_ASSERT_EQUAL(s_size, xf_heap_get_free_size());
+}
 
 TEST(heap_group, heap_uninit)
 {
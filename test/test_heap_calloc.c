@@ -0,0 +1,135 @@
+/**
+ * @file test_heap_calloc.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+TEST_GROUP(heap_calloc_group);
+
+/* 超过 2^30 字节的内存区域，按需分配物理页，只有内存块头会被写入 */
+#define LARGE_REGION_SIZE  (0x60000000u)
+#define LARGE_BLOCK_SIZE   (16u << 20)
+
+static char s_heap_arr[6144] = {0};
+
+static void *s_ptrs[LARGE_REGION_SIZE / LARGE_BLOCK_SIZE] = {0};
+
+TEST_SETUP(heap_calloc_group)
+{
+}
+
+TEST_TEAR_DOWN(heap_calloc_group)
+{
+    xf_heap_uninit();
+}
+
+TEST(heap_calloc_group, heap_calloc_clear)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 6144},
+        {NULL, 0}
+    };
+    memset(s_heap_arr, 0xAA, sizeof(s_heap_arr));
+    xf_heap_init(heap_regions);
+
+    uint8_t *p = xf_calloc(16, 8);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, p, 16 * 8);
+    memset(p, 0x55, 16 * 8);
+    xf_free(p);
+
+    /* 释放后的内存块已被使用过，需要重新清零 */
+    p = xf_calloc(16, 8);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, p, 16 * 8);
+    xf_free(p);
+}
+
+TEST(heap_calloc_group, heap_calloc_known_zero)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 6144, 1},
+        {NULL, 0}
+    };
+    /* 故意填充非0数据，验证声明已清零的内存区域不会被重复清零 */
+    memset(s_heap_arr, 0xAA, sizeof(s_heap_arr));
+    xf_heap_init(heap_regions);
+
+    uint8_t *p = xf_calloc(4, 4);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, p[4 * 4 - 1]);
+
+    /* 普通申请使用过的内存块释放后失去清零状态 */
+    uint8_t *q = xf_malloc(64);
+    TEST_ASSERT_NOT_NULL(q);
+    memset(q, 0x55, 64);
+    xf_free(q);
+    q = xf_calloc(1, 64);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, q, 64);
+    xf_free(q);
+    xf_free(p);
+}
+
+TEST(heap_calloc_group, heap_calloc_overflow)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 6144},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+
+    TEST_ASSERT_NULL(xf_calloc(0x10000, 0x10001));
+    TEST_ASSERT_NULL(xf_calloc(0xFFFFFFFF, 2));
+}
+
+TEST(heap_calloc_group, heap_calloc_large_region)
+{
+    void *region = mmap(NULL, LARGE_REGION_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    TEST_ASSERT_TRUE(region != MAP_FAILED);
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)region, LARGE_REGION_SIZE, 1},
+        {NULL, 0}
+    };
+    unsigned int total, num, round, again = 0;
+
+    xf_heap_init(heap_regions);
+    total = xf_heap_get_free_size();
+    TEST_ASSERT_GREATER_THAN(LARGE_REGION_SIZE - 4096, total);
+
+    /* 次高位为清零标志，内存区域被切割为多个内存块，每块最多损失一次申请的大小 */
+    for (round = 0; round < 2; round++) {
+        for (num = 0; num < LARGE_REGION_SIZE / LARGE_BLOCK_SIZE; num++) {
+            s_ptrs[num] = xf_malloc(LARGE_BLOCK_SIZE);
+            if (s_ptrs[num] == NULL) {
+                break;
+            }
+        }
+        TEST_ASSERT_GREATER_OR_EQUAL(LARGE_REGION_SIZE / LARGE_BLOCK_SIZE - 2 * XF_HEAP_SHARD_NUM - 1, num);
+        /* 释放后合并不超过单个内存块的上限，第二轮能申请到同样多的内存 */
+        if (round == 0) {
+            again = num;
+        } else {
+            TEST_ASSERT_EQUAL(again, num);
+        }
+        while (num > 0) {
+            xf_free(s_ptrs[--num]);
+        }
+        TEST_ASSERT_EQUAL(total, xf_heap_get_free_size());
+    }
+
+    xf_heap_uninit();
+    munmap(region, LARGE_REGION_SIZE);
+}
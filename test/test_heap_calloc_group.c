@@ -0,0 +1,11 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+
+
+TEST_GROUP_RUNNER(heap_calloc_group)
+{
+    RUN_TEST_CASE(heap_calloc_group, heap_calloc_clear);
+    RUN_TEST_CASE(heap_calloc_group, heap_calloc_known_zero);
+    RUN_TEST_CASE(heap_calloc_group, heap_calloc_overflow);
+    RUN_TEST_CASE(heap_calloc_group, heap_calloc_large_region);
+}
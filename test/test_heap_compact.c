@@ -0,0 +1,162 @@
+/**
+ * @file test_heap_compact.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_COMPACT_HEADER
+
+TEST_GROUP(heap_compact_group);
+
+#define SMALL_NUM 64
+#define SMALL_SIZE 16
+
+/* 已占用内存块头只有4字节的大小和标志 */
+#define COMPACT_HEADER_SIZE \
+    ((sizeof(unsigned int) + XF_HEAP_BYTE_ALIGNMENT - 1) & ~(XF_HEAP_BYTE_ALIGNMENT - 1))
+
+static char s_heap_arr[4096] = {0};
+
+TEST_SETUP(heap_compact_group)
+{
+}
+
+TEST_TEAR_DOWN(heap_compact_group)
+{
+    xf_heap_uninit();
+}
+
+TEST(heap_compact_group, heap_compact_overhead)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 4096},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+    unsigned int free_size = xf_heap_get_free_size();
+
+    /* 连续申请的内存块相邻，间距为用户区加上紧凑内存块头 */
+    uint8_t *p1 = xf_malloc(SMALL_SIZE);
+    uint8_t *p2 = xf_malloc(SMALL_SIZE);
+    TEST_ASSERT_NOT_NULL(p1);
+    TEST_ASSERT_NOT_NULL(p2);
+    TEST_ASSERT_EQUAL_UINT(SMALL_SIZE + COMPACT_HEADER_SIZE, p2 - p1);
+    TEST_ASSERT_EQUAL_UINT(free_size - 2 * (SMALL_SIZE + COMPACT_HEADER_SIZE),
+                           xf_heap_get_free_size());
+
+    xf_free(p1);
+    xf_free(p2);
+    TEST_ASSERT_EQUAL_UINT(free_size, xf_heap_get_free_size());
+}
+
+TEST(heap_compact_group, heap_compact_coalesce)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 2048},
+        {(uint8_t *)s_heap_arr + 2048, 2048},
+        {NULL, 0}
+    };
+    void *ptrs[SMALL_NUM];
+    unsigned int index;
+
+    xf_heap_init(heap_regions);
+    unsigned int free_size = xf_heap_get_free_size();
+
+    for (index = 0; index < SMALL_NUM; index++) {
+        ptrs[index] = xf_malloc(index % 3 + 1);
+        TEST_ASSERT_NOT_NULL(ptrs[index]);
+        memset(ptrs[index], 0x5A, index % 3 + 1);
+    }
+
+    /* 隔一个释放一个，再释放剩余的，空闲链表的偏移需要正确合并 */
+    for (index = 0; index < SMALL_NUM; index += 2) {
+        xf_free(ptrs[index]);
+    }
+    for (index = 1; index < SMALL_NUM; index += 2) {
+        xf_free(ptrs[index]);
+    }
+    TEST_ASSERT_EQUAL_UINT(free_size, xf_heap_get_free_size());
+
+    /* 合并后第二块注册内存可以被整块申请，分片时每个分片只有其中一部分 */
+    void *p = xf_malloc(1024 / XF_HEAP_SHARD_NUM);
+    TEST_ASSERT_NOT_NULL(p);
+    xf_free(p);
+    TEST_ASSERT_EQUAL_UINT(free_size, xf_heap_get_free_size());
+}
+
+TEST(heap_compact_group, heap_compact_calloc)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 4096, 1},
+        {NULL, 0}
+    };
+    memset(s_heap_arr, 0, sizeof(s_heap_arr));
+    xf_heap_init(heap_regions);
+
+    /* 空闲内存块的偏移位于用户区开头，已知全为0的内存块也需要清除 */
+    uint8_t *p = xf_calloc(4, 8);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, p, 4 * 8);
+
+    uint8_t *q = xf_calloc(4, 8);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, q, 4 * 8);
+
+    xf_free(p);
+    xf_free(q);
+}
+
+/* 分片时每个分片以自己的第一块内存为偏移起点 */
+#if (UINTPTR_MAX > 0xFFFFFFFFu) && (XF_HEAP_SHARD_NUM == 1)
+TEST(heap_compact_group, heap_compact_far_region)
+{
+    const size_t region_size = 64 * 1024;
+    const size_t far = (size_t) 4 << 30;
+    unsigned char *base;
+    unsigned int free_size;
+
+    /* 只保留地址空间，首尾两处按需映射 */
+    base = mmap(NULL, far + 2 * region_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    TEST_ASSERT_TRUE(base != MAP_FAILED);
+    TEST_ASSERT_EQUAL_INT(0, mprotect(base, region_size, PROT_READ | PROT_WRITE));
+    TEST_ASSERT_EQUAL_INT(0, mprotect(base + far + region_size, region_size, PROT_READ | PROT_WRITE));
+
+    xf_heap_region_t near_regions[] = {
+        {base, region_size},
+        {NULL, 0}
+    };
+    xf_heap_init(near_regions);
+    free_size = xf_heap_get_free_size();
+    xf_heap_uninit();
+
+    /* 超出 4GB 偏移范围的区域被跳过，不计入剩余内存，也不会被申请到 */
+    xf_heap_region_t heap_regions[] = {
+        {base, region_size},
+        {base + far + region_size, region_size},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+    TEST_ASSERT_EQUAL_UINT(free_size, xf_heap_get_free_size());
+
+    void *p = xf_malloc(region_size / 2);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_TRUE((unsigned char *) p < base + region_size);
+    TEST_ASSERT_NULL(xf_malloc(region_size / 2));
+    xf_free(p);
+
+    munmap(base, far + 2 * region_size);
+}
+#endif
+
+#endif // XF_HEAP_COMPACT_HEADER
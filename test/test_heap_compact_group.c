@@ -0,0 +1,17 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_COMPACT_HEADER
+
+TEST_GROUP_RUNNER(heap_compact_group)
+{
+    RUN_TEST_CASE(heap_compact_group, heap_compact_overhead);
+    RUN_TEST_CASE(heap_compact_group, heap_compact_coalesce);
+    RUN_TEST_CASE(heap_compact_group, heap_compact_calloc);
+#if (UINTPTR_MAX > 0xFFFFFFFFu) && (XF_HEAP_SHARD_NUM == 1)
+    RUN_TEST_CASE(heap_compact_group, heap_compact_far_region);
+#endif
+}
+
+#endif // XF_HEAP_COMPACT_HEADER
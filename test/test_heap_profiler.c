@@ -0,0 +1,147 @@
+/**
+ * @file test_heap_profiler.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+#include "xf_alloc.h"
+
+#if XF_HEAP_PROFILER_ENABLE
+
+TEST_GROUP(heap_profiler_group);
+
+#define PROFILER_TEST_NUM 32
+
+static char s_heap_arr[6144 * XF_HEAP_SHARD_NUM] = {0};
+
+static void *s_ptrs[PROFILER_TEST_NUM] = {0};
+
+static unsigned int s_lines = 0;
+
+static unsigned long s_bytes = 0;
+
+static unsigned int s_leaf_misses = 0;
+
+static unsigned int s_dropped = 0;
+
+/* 不内联，采样的最内层栈帧应为这里调用 xf_malloc 的位置，位于函数开头附近 */
+static void * __attribute__((noinline)) profiler_malloc(unsigned int size)
+{
+    return xf_malloc(size);
+}
+
+static void profiler_output(void *arg, const char *str, unsigned int len)
+{
+    unsigned int i = len - 1;
+    unsigned long bytes = 0, scale = 1;
+    const char *leaf;
+    uintptr_t site;
+
+    TEST_ASSERT_EQUAL('\n', str[len - 1]);
+    /* 采样记录已满时最后一行为 "[dropped] count\n" */
+    if (strncmp(str, "[dropped] ", 10) == 0) {
+        s_dropped = (unsigned int) strtoul(str + 10, NULL, 10);
+        return;
+    }
+    /* 行尾为 " bytes\n" */
+    while (str[--i] != ' ') {
+        bytes += (str[i] - '0') * scale;
+        scale *= 10;
+    }
+    TEST_ASSERT_EQUAL(0, strncmp(str, "0x", 2));
+
+    /* 折叠栈的最后一个栈帧为最内层 */
+    for (leaf = str + i; (leaf > str) && (leaf[-1] != ';'); leaf--) {
+    }
+    site = (uintptr_t) strtoull(leaf, NULL, 16);
+    if ((site <= (uintptr_t) profiler_malloc) || (site - (uintptr_t) profiler_malloc > 256)) {
+        s_leaf_misses++;
+    }
+
+    s_bytes += bytes;
+    s_lines++;
+}
+
+TEST_SETUP(heap_profiler_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, sizeof(s_heap_arr)},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+    s_lines = 0;
+    s_bytes = 0;
+    s_leaf_misses = 0;
+    s_dropped = 0;
+}
+
+TEST_TEAR_DOWN(heap_profiler_group)
+{
+    xf_heap_uninit();
+}
+
+TEST(heap_profiler_group, heap_profiler_dump)
+{
+    for (int i = 0; i < PROFILER_TEST_NUM; i++) {
+        s_ptrs[i] = profiler_malloc(64);
+        TEST_ASSERT_NOT_NULL(s_ptrs[i]);
+    }
+
+    /* 平均每256字节采样一次，共申请2048字节 */
+    xf_heap_profiler_dump(profiler_output, NULL);
+    TEST_ASSERT_GREATER_THAN(0, s_lines);
+    TEST_ASSERT_GREATER_THAN(0, s_bytes);
+    /* 调用栈不包含内存管理内部的栈帧 */
+    TEST_ASSERT_EQUAL(0, s_leaf_misses);
+
+    for (int i = 0; i < PROFILER_TEST_NUM; i++) {
+        xf_free(s_ptrs[i]);
+    }
+
+    /* 释放后不再保留采样 */
+    s_lines = 0;
+    xf_heap_profiler_dump(profiler_output, NULL);
+    TEST_ASSERT_EQUAL(0, s_lines);
+}
+
+TEST(heap_profiler_group, heap_profiler_dropped)
+{
+    unsigned int sampled = 0, dropped;
+
+    /* 共申请4096字节，平均采样16次，超出 XF_HEAP_PROFILER_MAX_SAMPLES 的采样被丢弃 */
+    for (int i = 0; i < PROFILER_TEST_NUM; i++) {
+        s_ptrs[i] = profiler_malloc(128);
+        TEST_ASSERT_NOT_NULL(s_ptrs[i]);
+        sampled += xf_heap_is_sampled(s_ptrs[i]);
+    }
+
+    dropped = xf_heap_profiler_dump(profiler_output, NULL);
+    TEST_ASSERT_GREATER_THAN(0, dropped);
+    TEST_ASSERT_EQUAL(dropped, s_dropped);
+    TEST_ASSERT_EQUAL(XF_HEAP_PROFILER_MAX_SAMPLES, s_lines);
+    /* 只有记录了采样的内存块被标记 */
+    TEST_ASSERT_EQUAL(s_lines, sampled);
+
+    for (int i = 0; i < PROFILER_TEST_NUM; i++) {
+        xf_free(s_ptrs[i]);
+    }
+
+    /* 释放后空出的采样记录可以再次使用，丢弃计数保留到重新初始化 */
+    s_lines = 0;
+    s_dropped = 0;
+    TEST_ASSERT_EQUAL(dropped, xf_heap_profiler_dump(profiler_output, NULL));
+    TEST_ASSERT_EQUAL(0, s_lines);
+    TEST_ASSERT_EQUAL(dropped, s_dropped);
+}
+
+#endif // XF_HEAP_PROFILER_ENABLE
@@ -0,0 +1,13 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_PROFILER_ENABLE
+
+TEST_GROUP_RUNNER(heap_profiler_group)
+{
+    RUN_TEST_CASE(heap_profiler_group, heap_profiler_dump);
+    RUN_TEST_CASE(heap_profiler_group, heap_profiler_dropped);
+}
+
+#endif // XF_HEAP_PROFILER_ENABLE
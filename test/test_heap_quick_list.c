@@ -0,0 +1,83 @@
+/**
+ * @file test_heap_quick_list.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_QUICK_LIST_ENABLE
+
+TEST_GROUP(heap_quick_list_group);
+
+#define QUICK_LIST_TEST_NUM 128
+
+static char s_heap_arr[6144] = {0};
+
+static void *s_ptrs[QUICK_LIST_TEST_NUM] = {0};
+
+TEST_SETUP(heap_quick_list_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 6144},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+}
+
+TEST_TEAR_DOWN(heap_quick_list_group)
+{
+    xf_heap_uninit();
+}
+
+TEST(heap_quick_list_group, heap_quick_list_reuse)
+{
+    size_t size = xf_heap_get_free_size();
+    void *p = xf_malloc(24);
+    void *q = xf_malloc(24);
+
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_NOT_NULL(q);
+    xf_free(p);
+    /* 同尺寸申请直接复用刚释放的内存块 */
+    TEST_ASSERT_EQUAL_PTR(p, xf_malloc(24));
+    xf_free(p);
+    xf_free(q);
+    TEST_ASSERT_EQUAL(size, xf_heap_get_free_size());
+}
+
+TEST(heap_quick_list_group, heap_quick_list_flush)
+{
+    size_t size = xf_heap_get_free_size();
+    int num = 0;
+
+    /* 用小内存块占满整个堆 */
+    while (num < QUICK_LIST_TEST_NUM) {
+        s_ptrs[num] = xf_malloc(48);
+        if (s_ptrs[num] == NULL) {
+            break;
+        }
+        num++;
+    }
+    TEST_ASSERT_LESS_THAN(QUICK_LIST_TEST_NUM, num);
+
+    for (int i = 0; i < num; i++) {
+        xf_free(s_ptrs[i]);
+    }
+    TEST_ASSERT_EQUAL(size, xf_heap_get_free_size());
+
+    /* 大内存申请需要合并所有暂存的内存块，分片时不能超过单个分片 */
+    void *p = xf_malloc(size / 2 / XF_HEAP_SHARD_NUM);
+    TEST_ASSERT_NOT_NULL(p);
+    xf_free(p);
+    TEST_ASSERT_EQUAL(size, xf_heap_get_free_size());
+}
+
+#endif // XF_HEAP_QUICK_LIST_ENABLE
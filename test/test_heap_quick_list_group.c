@@ -0,0 +1,13 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_QUICK_LIST_ENABLE
+
+TEST_GROUP_RUNNER(heap_quick_list_group)
+{
+    RUN_TEST_CASE(heap_quick_list_group, heap_quick_list_reuse);
+    RUN_TEST_CASE(heap_quick_list_group, heap_quick_list_flush);
+}
+
+#endif // XF_HEAP_QUICK_LIST_ENABLE
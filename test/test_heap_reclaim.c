@@ -0,0 +1,164 @@
+/**
+ * @file test_heap_reclaim.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+#include "xf_alloc.h"
+
+#if XF_HEAP_RECLAIM_ENABLE
+
+TEST_GROUP(heap_reclaim_group);
+
+#define CACHE_NUM 64
+
+static char s_heap_arr[4096] = {0};
+static void *s_cache[CACHE_NUM];
+static unsigned int s_reclaim_calls;
+static unsigned int s_pressure_calls;
+static xf_heap_pressure_t s_pressure;
+
+/* 模拟缓存，每次回收释放一个缓存块 */
+static unsigned int test_reclaim(void *ctx, unsigned int size)
+{
+    unsigned int *count = (unsigned int *)ctx;
+    unsigned int res;
+
+    s_reclaim_calls++;
+    if (*count == 0) {
+        return 0;
+    }
+    (*count)--;
+    res = xf_heap_get_free_size();
+    xf_free(s_cache[*count]);
+    return xf_heap_get_free_size() - res;
+}
+
+static unsigned int test_reclaim_none(void *ctx, unsigned int size)
+{
+    s_reclaim_calls++;
+    return 0;
+}
+
+static void test_watermark(void *ctx, xf_heap_pressure_t pressure, unsigned int free_bytes)
+{
+    s_pressure_calls++;
+    s_pressure = pressure;
+}
+
+/* 跨分片释放在释放队列中延后归还，回到内存块所属分片释放使水位立即更新 */
+static void test_free(void *pv)
+{
+#if XF_HEAP_SHARD_NUM > 1
+    test_heap_shard_id = xf_heap_shard_of(pv);
+#endif
+    xf_free(pv);
+}
+
+TEST_SETUP(heap_reclaim_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 4096},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+    s_reclaim_calls = 0;
+    s_pressure_calls = 0;
+}
+
+TEST_TEAR_DOWN(heap_reclaim_group)
+{
+    xf_heap_unregister_reclaim(test_reclaim_none, NULL);
+    xf_heap_set_watermark(0, 0, NULL, NULL);
+    xf_heap_uninit();
+#if XF_HEAP_SHARD_NUM > 1
+    test_heap_shard_id = 0;
+#endif
+}
+
+TEST(heap_reclaim_group, heap_reclaim_retry)
+{
+    unsigned int count = 0;
+
+    while (count < CACHE_NUM) {
+        s_cache[count] = xf_malloc(100);
+        if (s_cache[count] == NULL) {
+            break;
+        }
+        count++;
+    }
+    TEST_ASSERT_NULL(xf_malloc(100));
+
+    TEST_ASSERT_EQUAL(XF_HEAP_INVALID_ARG, xf_heap_register_reclaim(NULL, NULL));
+    TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_register_reclaim(test_reclaim_none, NULL));
+    TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_register_reclaim(test_reclaim, &count));
+
+    /* 第一个回调无可回收内存，第二个回调释放一个缓存块后重试成功 */
+    void *p = xf_malloc(100);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL(2, s_reclaim_calls);
+
+    /* 回调持续回收直到缓存全部释放，申请仍然失败 */
+    TEST_ASSERT_NULL(xf_malloc(8192));
+    TEST_ASSERT_EQUAL(0, count);
+
+    TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_unregister_reclaim(test_reclaim, &count));
+    TEST_ASSERT_EQUAL(XF_HEAP_INVALID_ARG, xf_heap_unregister_reclaim(test_reclaim, &count));
+    s_reclaim_calls = 0;
+    TEST_ASSERT_NULL(xf_malloc(8192));
+    TEST_ASSERT_EQUAL(1, s_reclaim_calls);
+    xf_free(p);
+}
+
+TEST(heap_reclaim_group, heap_reclaim_full)
+{
+    unsigned int i;
+
+    for (i = 0; i < XF_HEAP_RECLAIM_NUM; i++) {
+        TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_register_reclaim(test_reclaim_none, NULL));
+    }
+    TEST_ASSERT_EQUAL(XF_HEAP_FULL, xf_heap_register_reclaim(test_reclaim_none, NULL));
+    for (i = 1; i < XF_HEAP_RECLAIM_NUM; i++) {
+        TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_unregister_reclaim(test_reclaim_none, NULL));
+    }
+}
+
+TEST(heap_reclaim_group, heap_watermark)
+{
+    unsigned int total = xf_heap_get_free_size();
+    void *p[4];
+    unsigned int i;
+
+    TEST_ASSERT_EQUAL(XF_HEAP_INVALID_ARG, xf_heap_set_watermark(total / 2, total / 4, test_watermark, NULL));
+    TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_set_watermark(total / 2, total * 3 / 4, test_watermark, NULL));
+
+    for (i = 0; i < 4; i++) {
+        p[i] = xf_malloc(total / 6);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    /* 低于低水位只通知一次 */
+    TEST_ASSERT_EQUAL(1, s_pressure_calls);
+    TEST_ASSERT_EQUAL(XF_HEAP_PRESSURE_LOW, s_pressure);
+    TEST_ASSERT_EQUAL(XF_HEAP_PRESSURE_LOW, xf_heap_get_pressure());
+
+    /* 回升到两个水位之间不通知 */
+    test_free(p[3]);
+    test_free(p[2]);
+    TEST_ASSERT_EQUAL(1, s_pressure_calls);
+
+    test_free(p[1]);
+    TEST_ASSERT_EQUAL(2, s_pressure_calls);
+    TEST_ASSERT_EQUAL(XF_HEAP_PRESSURE_NORMAL, s_pressure);
+    test_free(p[0]);
+    TEST_ASSERT_EQUAL(2, s_pressure_calls);
+}
+
+#endif // XF_HEAP_RECLAIM_ENABLE
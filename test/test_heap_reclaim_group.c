@@ -0,0 +1,14 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_RECLAIM_ENABLE
+
+TEST_GROUP_RUNNER(heap_reclaim_group)
+{
+    RUN_TEST_CASE(heap_reclaim_group, heap_reclaim_retry);
+    RUN_TEST_CASE(heap_reclaim_group, heap_reclaim_full);
+    RUN_TEST_CASE(heap_reclaim_group, heap_watermark);
+}
+
+#endif // XF_HEAP_RECLAIM_ENABLE
@@ -0,0 +1,115 @@
+/**
+ * @file test_heap_remote_free.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+#include "xf_alloc.h"
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+
+TEST_GROUP(heap_remote_free_group);
+
+#define REMOTE_FREE_NUM 32
+
+static char s_heap_arr[6144] = {0};
+
+static void *s_ptrs[REMOTE_FREE_NUM] = {0};
+
+static unsigned int s_ptr_num = 0;
+
+static void *remote_free_task(void *arg)
+{
+#if XF_HEAP_SHARD_NUM > 1
+    /* 分片模式下按分片判断是否跨线程释放，释放线程使用其他分片 */
+    test_heap_shard_id = 1;
+#endif
+    for (unsigned int i = 0; i < s_ptr_num; i++) {
+        xf_free(s_ptrs[i]);
+    }
+    return NULL;
+}
+
+/* 在其他线程释放 s_ptrs 中的内存，并检查释放被推迟：内存块仍处于占用状态，在用字节数不变 */
+static void remote_free_deferred(unsigned int num)
+{
+    pthread_t thread;
+#if XF_HEAP_TAG_ENABLE
+    xf_heap_tag_stats_t before, after;
+
+    TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_get_tag_stats(0, &before));
+#endif
+
+    s_ptr_num = num;
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, remote_free_task, NULL));
+    TEST_ASSERT_EQUAL(0, pthread_join(thread, NULL));
+
+    /* 以下查询都不归还释放队列 */
+    for (unsigned int i = 0; i < num; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, xf_heap_get_block_size(s_ptrs[i]));
+    }
+#if XF_HEAP_TAG_ENABLE
+    TEST_ASSERT_EQUAL(XF_HEAP_OK, xf_heap_get_tag_stats(0, &after));
+    TEST_ASSERT_EQUAL(before.live_bytes, after.live_bytes);
+#endif
+}
+
+TEST_SETUP(heap_remote_free_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 6144},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+}
+
+TEST_TEAR_DOWN(heap_remote_free_group)
+{
+    xf_heap_uninit();
+}
+
+TEST(heap_remote_free_group, heap_remote_free)
+{
+    size_t size = xf_heap_get_free_size();
+
+    for (int i = 0; i < REMOTE_FREE_NUM; i++) {
+        s_ptrs[i] = xf_malloc(i + 1);
+        TEST_ASSERT_NOT_NULL(s_ptrs[i]);
+    }
+
+    remote_free_deferred(REMOTE_FREE_NUM);
+
+    /* 所属线程再次申请时归还跨线程释放的内存 */
+    void *p = xf_malloc(sizeof(int));
+    TEST_ASSERT_NOT_NULL(p);
+    for (int i = 0; i < REMOTE_FREE_NUM; i++) {
+        TEST_ASSERT_TRUE((s_ptrs[i] == p) || (xf_heap_get_block_size(s_ptrs[i]) == 0));
+    }
+    xf_free(p);
+    TEST_ASSERT_EQUAL(size, xf_heap_get_free_size());
+}
+
+TEST(heap_remote_free_group, heap_remote_free_size)
+{
+    size_t size = xf_heap_get_free_size();
+
+    s_ptrs[0] = xf_malloc(REMOTE_FREE_NUM * 2);
+    TEST_ASSERT_NOT_NULL(s_ptrs[0]);
+    TEST_ASSERT_NOT_EQUAL(size, xf_heap_get_free_size());
+
+    remote_free_deferred(1);
+
+    /* 查询剩余内存时归还跨线程释放的内存 */
+    TEST_ASSERT_EQUAL(size, xf_heap_get_free_size());
+    TEST_ASSERT_EQUAL(0, xf_heap_get_block_size(s_ptrs[0]));
+}
+
+#endif // XF_HEAP_REMOTE_FREE_ENABLE
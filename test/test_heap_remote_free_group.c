@@ -0,0 +1,13 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_REMOTE_FREE_ENABLE
+
+TEST_GROUP_RUNNER(heap_remote_free_group)
+{
+    RUN_TEST_CASE(heap_remote_free_group, heap_remote_free);
+    RUN_TEST_CASE(heap_remote_free_group, heap_remote_free_size);
+}
+
+#endif // XF_HEAP_REMOTE_FREE_ENABLE
@@ -0,0 +1,236 @@
+/**
+ * @file test_heap_shard.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+#include "xf_alloc.h"
+
+#if XF_HEAP_SHARD_NUM > 1
+
+TEST_GROUP(heap_shard_group);
+
+#define SHARD_THREAD_ROUNDS 64
+#define SHARD_THREAD_BLOCKS 8
+
+pthread_mutex_t test_heap_shard_locks[XF_HEAP_SHARD_NUM] = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+};
+__thread unsigned int test_heap_shard_id;
+
+/* 两块内存之间留有空隙：第一块 3072 字节，第二块 4096 字节，每个分片 1792 字节 */
+static char s_heap_arr[8192] = {0};
+
+/* 各分片起始位置相对 s_heap_arr 的偏移，分片1横跨两块内存 */
+static const unsigned int s_shard_start[XF_HEAP_SHARD_NUM + 1] = {0, 1792, 4608, 6400, 8192};
+
+static void *s_thread_ptrs[XF_HEAP_SHARD_NUM][SHARD_THREAD_BLOCKS];
+static pthread_barrier_t s_barrier;
+static unsigned int s_thread_failed;
+
+/* 每个线程使用一个分片，申请后释放下一个线程申请的内存，全部是跨分片释放 */
+static void *shard_thread_task(void *arg)
+{
+    unsigned int shard = (unsigned int)(uintptr_t) arg;
+    unsigned int round, index;
+
+    test_heap_shard_id = shard;
+    for (round = 0; round < SHARD_THREAD_ROUNDS; round++) {
+        for (index = 0; index < SHARD_THREAD_BLOCKS; index++) {
+            s_thread_ptrs[shard][index] = xf_malloc((round + index) % 64 + 1);
+            if (s_thread_ptrs[shard][index] == NULL) {
+                __atomic_add_fetch(&s_thread_failed, 1, __ATOMIC_RELAXED);
+            }
+        }
+        pthread_barrier_wait(&s_barrier);
+        for (index = 0; index < SHARD_THREAD_BLOCKS; index++) {
+            xf_free(s_thread_ptrs[(shard + 1) % XF_HEAP_SHARD_NUM][index]);
+        }
+        pthread_barrier_wait(&s_barrier);
+    }
+
+    return NULL;
+}
+
+TEST_SETUP(heap_shard_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 3072},
+        {(uint8_t *)s_heap_arr + 4096, 4096},
+        {NULL, 0}
+    };
+    test_heap_shard_id = 0;
+    xf_heap_init(heap_regions);
+}
+
+TEST_TEAR_DOWN(heap_shard_group)
+{
+    xf_heap_uninit();
+    test_heap_shard_id = 0;
+}
+
+TEST(heap_shard_group, heap_shard_region)
+{
+    unsigned int shard;
+
+    /* 多块内存按地址均分，每个分片的块头和结束标记只占少量内存 */
+    TEST_ASSERT_LESS_OR_EQUAL(3072 + 4096, xf_heap_get_free_size());
+    TEST_ASSERT_GREATER_THAN(3072 + 4096 - XF_HEAP_SHARD_NUM * 64, xf_heap_get_free_size());
+
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        TEST_ASSERT_EQUAL(shard, xf_heap_shard_of(s_heap_arr + s_shard_start[shard] + 16));
+        TEST_ASSERT_EQUAL(shard, xf_heap_shard_of(s_heap_arr + s_shard_start[shard + 1] - 64));
+    }
+    /* 分片1的后半部分位于第二块内存 */
+    TEST_ASSERT_EQUAL(1, xf_heap_shard_of(s_heap_arr + 4096 + 16));
+}
+
+TEST(heap_shard_group, heap_shard_route)
+{
+    void *p[XF_HEAP_SHARD_NUM];
+    unsigned int shard;
+
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        test_heap_shard_id = shard;
+        p[shard] = xf_malloc(32);
+        TEST_ASSERT_NOT_NULL(p[shard]);
+        TEST_ASSERT_EQUAL(shard, xf_heap_shard_of(p[shard]));
+        TEST_ASSERT_GREATER_OR_EQUAL((uintptr_t)(s_heap_arr + s_shard_start[shard]), (uintptr_t)p[shard]);
+        TEST_ASSERT_LESS_THAN((uintptr_t)(s_heap_arr + s_shard_start[shard + 1]), (uintptr_t)p[shard]);
+    }
+
+    /* XF_HEAP_SHARD_ID 超出分片数时取模 */
+    test_heap_shard_id = XF_HEAP_SHARD_NUM + 2;
+    void *q = xf_malloc(32);
+    TEST_ASSERT_EQUAL(2, xf_heap_shard_of(q));
+    xf_free(q);
+
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        test_heap_shard_id = shard;
+        xf_free(p[shard]);
+    }
+}
+
+TEST(heap_shard_group, heap_shard_steal)
+{
+    unsigned int total = xf_heap_get_free_size();
+    void *p[64];
+    unsigned int num = 0, second_region = 0;
+
+    /* 分片1的内存用完后从分片2借用，分片1的两块内存都被使用 */
+    test_heap_shard_id = 1;
+    do {
+        p[num] = xf_malloc(64);
+        TEST_ASSERT_NOT_NULL(p[num]);
+        if ((char *)p[num] >= s_heap_arr + 4096) {
+            second_region = 1;
+        }
+    } while (xf_heap_shard_of(p[num++]) == 1);
+    TEST_ASSERT_EQUAL(2, xf_heap_shard_of(p[num - 1]));
+    TEST_ASSERT_EQUAL(1, second_region);
+
+    /* 最后一个分片用完后回到分片0借用 */
+    test_heap_shard_id = 3;
+    void *q = xf_malloc(1200);
+    TEST_ASSERT_EQUAL(3, xf_heap_shard_of(q));
+    void *r = xf_malloc(1200);
+    TEST_ASSERT_EQUAL(0, xf_heap_shard_of(r));
+    xf_free(q);
+    xf_free(r);
+    while (num > 0) {
+        xf_free(p[--num]);
+    }
+    TEST_ASSERT_EQUAL(total, xf_heap_get_free_size());
+
+    /* 单次申请不能跨分片，空堆上也无法申请超过一个分片的内存 */
+    TEST_ASSERT_NULL(xf_malloc(total / 2));
+    q = xf_malloc(total / XF_HEAP_SHARD_NUM / 2);
+    TEST_ASSERT_NOT_NULL(q);
+    xf_free(q);
+}
+
+TEST(heap_shard_group, heap_shard_cross_free)
+{
+    unsigned int total = xf_heap_get_free_size();
+
+    test_heap_shard_id = 0;
+    void *p = xf_malloc(64);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL(0, xf_heap_shard_of(p));
+
+    /* 在分片1释放分片0的内存 */
+    test_heap_shard_id = 1;
+    xf_free(p);
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    /* 压入分片0的释放队列，内存块仍处于占用状态，直到分片0归还 */
+    TEST_ASSERT_NOT_EQUAL(0, xf_heap_get_block_size(p));
+    test_heap_shard_id = 0;
+    void *q = xf_malloc(sizeof(int));
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_TRUE((p == q) || (xf_heap_get_block_size(p) == 0));
+    xf_free(q);
+#else
+    /* 直接加锁归还到分片0 */
+    TEST_ASSERT_EQUAL(0, xf_heap_get_block_size(p));
+#endif
+    TEST_ASSERT_EQUAL(total, xf_heap_get_free_size());
+}
+
+TEST(heap_shard_group, heap_shard_free_size)
+{
+    unsigned int total = xf_heap_get_free_size();
+    unsigned int used = 0;
+    void *p[XF_HEAP_SHARD_NUM];
+    unsigned int shard;
+
+    TEST_ASSERT_EQUAL(total, xf_heap_get_min_ever_free_size());
+
+    /* 剩余内存和历史最小剩余内存是所有分片的总和 */
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        test_heap_shard_id = shard;
+        p[shard] = xf_malloc(100 * (shard + 1));
+        TEST_ASSERT_NOT_NULL(p[shard]);
+        used += xf_heap_get_block_size(p[shard]);
+        TEST_ASSERT_EQUAL(total - used, xf_heap_get_free_size());
+        TEST_ASSERT_EQUAL(total - used, xf_heap_get_min_ever_free_size());
+    }
+
+    /* 跨分片释放的内存在查询剩余内存时归还 */
+    test_heap_shard_id = 0;
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        xf_free(p[shard]);
+    }
+    TEST_ASSERT_EQUAL(total, xf_heap_get_free_size());
+    TEST_ASSERT_EQUAL(total - used, xf_heap_get_min_ever_free_size());
+}
+
+TEST(heap_shard_group, heap_shard_threads)
+{
+    unsigned int total = xf_heap_get_free_size();
+    pthread_t threads[XF_HEAP_SHARD_NUM];
+    unsigned int shard;
+
+    s_thread_failed = 0;
+    TEST_ASSERT_EQUAL(0, pthread_barrier_init(&s_barrier, NULL, XF_HEAP_SHARD_NUM));
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[shard], NULL, shard_thread_task, (void *)(uintptr_t) shard));
+    }
+    for (shard = 0; shard < XF_HEAP_SHARD_NUM; shard++) {
+        TEST_ASSERT_EQUAL(0, pthread_join(threads[shard], NULL));
+    }
+    pthread_barrier_destroy(&s_barrier);
+
+    TEST_ASSERT_EQUAL(0, s_thread_failed);
+    TEST_ASSERT_EQUAL(total, xf_heap_get_free_size());
+}
+
+#endif // XF_HEAP_SHARD_NUM > 1
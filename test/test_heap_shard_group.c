@@ -0,0 +1,17 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_SHARD_NUM > 1
+
+TEST_GROUP_RUNNER(heap_shard_group)
+{
+    RUN_TEST_CASE(heap_shard_group, heap_shard_region);
+    RUN_TEST_CASE(heap_shard_group, heap_shard_route);
+    RUN_TEST_CASE(heap_shard_group, heap_shard_steal);
+    RUN_TEST_CASE(heap_shard_group, heap_shard_cross_free);
+    RUN_TEST_CASE(heap_shard_group, heap_shard_free_size);
+    RUN_TEST_CASE(heap_shard_group, heap_shard_threads);
+}
+
+#endif // XF_HEAP_SHARD_NUM > 1
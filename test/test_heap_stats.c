@@ -0,0 +1,95 @@
+/**
+ * @file test_heap_stats.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_STATS_ENABLE
+
+TEST_GROUP(heap_stats_group);
+
+#define STATS_TEST_NUM 16
+
+/* 分片时每个分片都能容纳全部测试内存块，不会向其他分片借用 */
+static char s_heap_arr[6144 * XF_HEAP_SHARD_NUM] = {0};
+
+static void *s_ptrs[STATS_TEST_NUM] = {0};
+
+static unsigned int s_cycles = 0;
+
+static xf_heap_stats_t s_stats;
+
+/* 每读取一次计数加1，使每次操作的耗时固定，分片测试会在多个线程中读取 */
+unsigned int test_heap_cycles(void)
+{
+    return __atomic_fetch_add(&s_cycles, 1, __ATOMIC_RELAXED);
+}
+
+TEST_SETUP(heap_stats_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, sizeof(s_heap_arr)},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+    xf_heap_reset_stats();
+}
+
+TEST_TEAR_DOWN(heap_stats_group)
+{
+    xf_heap_uninit();
+}
+
+TEST(heap_stats_group, heap_stats_count)
+{
+    for (int i = 0; i < STATS_TEST_NUM; i++) {
+        s_ptrs[i] = xf_malloc(100);
+        TEST_ASSERT_NOT_NULL(s_ptrs[i]);
+    }
+    for (int i = 0; i < STATS_TEST_NUM; i++) {
+        xf_free(s_ptrs[i]);
+    }
+
+    xf_heap_get_stats(&s_stats);
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM, s_stats.malloc_cycles.count);
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM, s_stats.free_cycles.count);
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM, s_stats.search_nodes.count);
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM * 2, s_stats.lock_wait_cycles.count);
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM * 2, s_stats.lock_hold_cycles.count);
+    /* 100 字节属于 [64, 128) 级 */
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM, s_stats.malloc_size_cycles[3].count);
+    /* 等锁时间固定为1个周期，落在第1个桶 */
+    TEST_ASSERT_EQUAL(STATS_TEST_NUM * 2, s_stats.lock_wait_cycles.buckets[1]);
+    TEST_ASSERT_EQUAL(1, s_stats.lock_wait_cycles.max);
+
+    xf_heap_reset_stats();
+    xf_heap_get_stats(&s_stats);
+    TEST_ASSERT_EQUAL(0, s_stats.malloc_cycles.count);
+    TEST_ASSERT_EQUAL(0, s_stats.lock_wait_cycles.total);
+}
+
+TEST(heap_stats_group, heap_stats_once)
+{
+    /* 超过堆大小的申请依次尝试每个分片后失败 */
+    TEST_ASSERT_NULL(xf_malloc(sizeof(s_heap_arr) * 2));
+
+    /* 整次申请只统计一次耗时，等锁和访问节点数按每次尝试统计 */
+    xf_heap_get_stats(&s_stats);
+    TEST_ASSERT_EQUAL(1, s_stats.malloc_cycles.count);
+    TEST_ASSERT_EQUAL(1, s_stats.malloc_size_cycles[XF_HEAP_STATS_SIZE_CLASSES - 1].count);
+    TEST_ASSERT_EQUAL(XF_HEAP_SHARD_NUM, s_stats.lock_wait_cycles.count);
+    TEST_ASSERT_EQUAL(XF_HEAP_SHARD_NUM, s_stats.search_nodes.count);
+    /* 每次尝试读取3次周期计数，整次耗时覆盖所有尝试 */
+    TEST_ASSERT_GREATER_OR_EQUAL(3 * XF_HEAP_SHARD_NUM, s_stats.malloc_cycles.max);
+}
+
+#endif // XF_HEAP_STATS_ENABLE
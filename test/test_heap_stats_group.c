@@ -0,0 +1,13 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_STATS_ENABLE
+
+TEST_GROUP_RUNNER(heap_stats_group)
+{
+    RUN_TEST_CASE(heap_stats_group, heap_stats_count);
+    RUN_TEST_CASE(heap_stats_group, heap_stats_once);
+}
+
+#endif // XF_HEAP_STATS_ENABLE
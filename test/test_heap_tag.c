@@ -0,0 +1,142 @@
+/**
+ * @file test_heap_tag.c
+ * @author cangyu (sky.kirto@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026, CorAL. All rights reserved.
+ *
+ */
+
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_TAG_ENABLE
+
+TEST_GROUP(heap_tag_group);
+
+#define TAG_CACHE 1
+#define TAG_NET 2
+#define CACHE_NUM 16
+
+static char s_heap_arr[4096] = {0};
+
+#if XF_HEAP_RECLAIM_ENABLE
+static unsigned int s_reclaim_calls;
+
+static unsigned int test_reclaim(void *ctx, unsigned int size)
+{
+    s_reclaim_calls++;
+    return 0;
+}
+#endif
+
+TEST_SETUP(heap_tag_group)
+{
+    xf_heap_region_t heap_regions[] = {
+        {(uint8_t *)s_heap_arr, 4096},
+        {NULL, 0}
+    };
+    xf_heap_init(heap_regions);
+}
+
+TEST_TEAR_DOWN(heap_tag_group)
+{
+    xf_heap_set_tag_budget(TAG_CACHE, 0);
+#if XF_HEAP_RECLAIM_ENABLE
+    xf_heap_unregister_reclaim(test_reclaim, NULL);
+#endif
+    xf_heap_uninit();
+}
+
+TEST(heap_tag_group, heap_tag_stats)
+{
+    xf_heap_tag_stats_t stats;
+    unsigned int free_size = xf_heap_get_free_size();
+
+    void *p1 = xf_malloc_tagged(100, TAG_CACHE);
+    void *p2 = xf_malloc_tagged(200, TAG_CACHE);
+    void *p3 = xf_malloc(50);
+    TEST_ASSERT_NOT_NULL(p1);
+    TEST_ASSERT_NOT_NULL(p2);
+    TEST_ASSERT_NOT_NULL(p3);
+
+    /* 标签按内存块大小统计，与剩余内存的扣除一致 */
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_OK, xf_heap_get_tag_stats(TAG_CACHE, &stats));
+    TEST_ASSERT_EQUAL_UINT(2, stats.count);
+    TEST_ASSERT_GREATER_OR_EQUAL(300, stats.live_bytes);
+    TEST_ASSERT_EQUAL_UINT(stats.live_bytes, stats.peak_bytes);
+    TEST_ASSERT_EQUAL_UINT(0, stats.budget);
+    unsigned int cache_bytes = stats.live_bytes;
+
+    /* 未指定标签的申请计入标签0 */
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_OK, xf_heap_get_tag_stats(0, &stats));
+    TEST_ASSERT_EQUAL_UINT(1, stats.count);
+    TEST_ASSERT_EQUAL_UINT(free_size - cache_bytes - stats.live_bytes, xf_heap_get_free_size());
+
+    xf_free(p1);
+    xf_free(p2);
+    xf_free(p3);
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_OK, xf_heap_get_tag_stats(TAG_CACHE, &stats));
+    TEST_ASSERT_EQUAL_UINT(0, stats.count);
+    TEST_ASSERT_EQUAL_UINT(0, stats.live_bytes);
+    TEST_ASSERT_EQUAL_UINT(cache_bytes, stats.peak_bytes);
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_OK, xf_heap_get_tag_stats(0, &stats));
+    TEST_ASSERT_EQUAL_UINT(0, stats.live_bytes);
+}
+
+TEST(heap_tag_group, heap_tag_budget)
+{
+    xf_heap_tag_stats_t stats;
+    void *cache[CACHE_NUM] = {0};
+    unsigned int count;
+
+#if XF_HEAP_RECLAIM_ENABLE
+    xf_heap_register_reclaim(test_reclaim, NULL);
+#endif
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_OK, xf_heap_set_tag_budget(TAG_CACHE, 1024));
+
+    /* 超出上限后申请直接失败，不调用回收回调 */
+    for (count = 0; count < CACHE_NUM; count++) {
+        cache[count] = xf_malloc_tagged(128, TAG_CACHE);
+        if (cache[count] == NULL) {
+            break;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, count);
+    TEST_ASSERT_LESS_THAN(CACHE_NUM, count);
+#if XF_HEAP_RECLAIM_ENABLE
+    TEST_ASSERT_EQUAL_UINT(0, s_reclaim_calls);
+#endif
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_OK, xf_heap_get_tag_stats(TAG_CACHE, &stats));
+    TEST_ASSERT_LESS_OR_EQUAL(1024, stats.live_bytes);
+    TEST_ASSERT_EQUAL_UINT(count, stats.count);
+
+    /* 其他标签不受影响 */
+    void *p = xf_malloc_tagged(512, TAG_NET);
+    TEST_ASSERT_NOT_NULL(p);
+    xf_free(p);
+
+    /* 释放后可以再次申请 */
+    xf_free(cache[count - 1]);
+    cache[count - 1] = xf_malloc_tagged(128, TAG_CACHE);
+    TEST_ASSERT_NOT_NULL(cache[count - 1]);
+
+    while (count > 0) {
+        xf_free(cache[--count]);
+    }
+}
+
+TEST(heap_tag_group, heap_tag_invalid)
+{
+    xf_heap_tag_stats_t stats;
+
+    TEST_ASSERT_NULL(xf_malloc_tagged(16, XF_HEAP_TAG_NUM));
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_INVALID_ARG, xf_heap_set_tag_budget(XF_HEAP_TAG_NUM, 16));
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_INVALID_ARG, xf_heap_get_tag_stats(XF_HEAP_TAG_NUM, &stats));
+    TEST_ASSERT_EQUAL_INT(XF_HEAP_INVALID_ARG, xf_heap_get_tag_stats(0, NULL));
+}
+
+#endif // XF_HEAP_TAG_ENABLE
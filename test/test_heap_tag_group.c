@@ -0,0 +1,14 @@
+#include "unity/unity.h"
+#include "unity/unity_fixture.h"
+#include "xf_heap.h"
+
+#if XF_HEAP_TAG_ENABLE
+
+TEST_GROUP_RUNNER(heap_tag_group)
+{
+    RUN_TEST_CASE(heap_tag_group, heap_tag_stats);
+    RUN_TEST_CASE(heap_tag_group, heap_tag_budget);
+    RUN_TEST_CASE(heap_tag_group, heap_tag_invalid);
+}
+
+#endif // XF_HEAP_TAG_ENABLE
@@ -1,8 +1,34 @@
 #include "unity/unity_fixture.h"
+#include "xf_heap.h"
 
 static void RunAllTests(void)
 {
     RUN_TEST_GROUP(heap_group);
+#if XF_HEAP_REMOTE_FREE_ENABLE
+    RUN_TEST_GROUP(heap_remote_free_group);
+#endif
+#if XF_HEAP_QUICK_LIST_ENABLE
+    RUN_TEST_GROUP(heap_quick_list_group);
+#endif
+#if XF_HEAP_PROFILER_ENABLE
+    RUN_TEST_GROUP(heap_profiler_group);
+#endif
+#if XF_HEAP_STATS_ENABLE
+    RUN_TEST_GROUP(heap_stats_group);
+#endif
+    RUN_TEST_GROUP(heap_calloc_group);
+#if XF_HEAP_RECLAIM_ENABLE
+    RUN_TEST_GROUP(heap_reclaim_group);
+#endif
+#if XF_HEAP_COMPACT_HEADER
+    RUN_TEST_GROUP(heap_compact_group);
+#endif
+#if XF_HEAP_TAG_ENABLE
+    RUN_TEST_GROUP(heap_tag_group);
+#endif
+#if XF_HEAP_SHARD_NUM > 1
+    RUN_TEST_GROUP(heap_shard_group);
+#endif
     RUN_TEST_GROUP(heap_redirect_group);
 }
 
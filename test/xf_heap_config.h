@@ -1 +1,60 @@
-#include <stdint.h>
\ No newline at end of file
+#include <stdint.h>
+#include <pthread.h>
+
+/**
+ * xf_heap_test 使用默认配置，与 example、bench 一致；
+ * xf_heap_test_all 定义 XF_HEAP_TEST_ALL，开启全部可选功能，
+ * 只有对应功能开启时才运行该功能的测试
+ */
+
+#ifdef XF_HEAP_TEST_ALL
+
+/* 单元测试开启跨线程释放队列，以 pthread_self 作为线程标识 */
+#define XF_HEAP_REMOTE_FREE_ENABLE 1
+#define XF_HEAP_THREAD_ID() ((xf_heap_intptr_t)pthread_self())
+
+/* 单元测试开启快速链表 */
+#define XF_HEAP_QUICK_LIST_ENABLE 1
+
+/* 单元测试开启采样内存分析，使用glibc获取调用栈 */
+#include <execinfo.h>
+#define XF_HEAP_PROFILER_ENABLE 1
+#define XF_HEAP_PROFILER_SAMPLE_RATE 256
+#define XF_HEAP_BACKTRACE(FRAMES, DEPTH) backtrace((FRAMES), (DEPTH))
+#define XF_HEAP_PROFILER_MAX_SAMPLES 4
+
+/* 单元测试开启耗时统计，周期计数由测试用例提供 */
+unsigned int test_heap_cycles(void);
+#define XF_HEAP_STATS_ENABLE 1
+#define XF_HEAP_CYCLES() test_heap_cycles()
+
+/* 单元测试开启内存压力回调 */
+#define XF_HEAP_RECLAIM_ENABLE 1
+
+/* 单元测试开启紧凑内存块头 */
+#define XF_HEAP_COMPACT_HEADER 1
+
+/* 单元测试开启内存标签 */
+#define XF_HEAP_TAG_ENABLE 1
+
+#endif // XF_HEAP_TEST_ALL
+
+/**
+ * xf_heap_test_shard 定义 XF_HEAP_TEST_SHARD，把内存分为4个分片，每个分片一把互斥锁，
+ * 当前分片由测试用例通过线程局部的 test_heap_shard_id 指定
+ */
+
+#ifdef XF_HEAP_TEST_SHARD
+
+#define XF_HEAP_SHARD_NUM 4
+
+extern pthread_mutex_t test_heap_shard_locks[XF_HEAP_SHARD_NUM];
+extern __thread unsigned int test_heap_shard_id;
+
+#define XF_HEAP_SHARD_ID() test_heap_shard_id
+#define XF_HEAP_SHARD_LOCK_PTR(SHARD) ((void *)&test_heap_shard_locks[SHARD])
+#define XF_HEAP_LOCK_PTR ((void *)&test_heap_shard_locks[0])
+#define XF_HEAP_LOCK(PLOCK) pthread_mutex_lock((pthread_mutex_t *)(PLOCK))
+#define XF_HEAP_UNLOCK(PLOCK) pthread_mutex_unlock((pthread_mutex_t *)(PLOCK))
+
+#endif // XF_HEAP_TEST_SHARD
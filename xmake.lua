@@ -2,15 +2,35 @@ add_rules("mode.debug")
 
 add_requires("unity_test")
 
-target("xf_heap_test")
-    set_kind("binary")
-    add_cflags("-Wall")
-    add_defines("UNITY_INCLUDE_CONFIG_H")
-    add_packages("unity_test")
-    add_includedirs("test")
-    add_includedirs("src")
-    add_files("src/*.c")
-    add_files("test/*.c")
+-- 单元测试，配置见 test/xf_heap_config.h
+function xf_heap_test(name, defines)
+    target(name)
+        set_kind("binary")
+        add_cflags("-Wall")
+        add_defines("UNITY_INCLUDE_CONFIG_H")
+        if defines then
+            add_defines(defines)
+        end
+        add_packages("unity_test")
+        add_syslinks("pthread")
+        add_includedirs("test")
+        add_includedirs("src")
+        add_files("src/*.c")
+        add_files("test/*.c")
+    target_end()
+end
+
+-- 默认配置
+xf_heap_test("xf_heap_test")
+
+-- 开启全部可选功能
+xf_heap_test("xf_heap_test_all", "XF_HEAP_TEST_ALL")
+
+-- 分片堆，每个分片一把锁
+xf_heap_test("xf_heap_test_shard", "XF_HEAP_TEST_SHARD")
+
+-- 分片堆并开启全部可选功能
+xf_heap_test("xf_heap_test_shard_all", {"XF_HEAP_TEST_SHARD", "XF_HEAP_TEST_ALL"})
 
 target("xf_heap")
     set_kind("binary")
@@ -18,3 +38,22 @@ target("xf_heap")
     add_files("src/*.c")
     add_includedirs("example")
     add_files("example/*.c")
+
+target("xf_heap_bench")
+    set_kind("binary")
+    add_includedirs("src")
+    add_files("src/*.c")
+    add_includedirs("bench")
+    add_files("bench/*.c")
+    if is_plat("linux") then
+        add_includedirs("port/linux")
+        add_files("port/linux/*.c")
+    end
+
+target("xf_heap_preload")
+    set_kind("shared")
+    add_syslinks("pthread")
+    add_includedirs("src")
+    add_files("src/*.c")
+    add_includedirs("preload")
+    add_files("preload/*.c")